@@ -5,6 +5,7 @@
 // Allocate the JSON document
 StaticJsonDocument<4000> status;
 StaticJsonDocument<1000> media; // media list
+char answer[MAX_RESPONSE_LEN];    // the JSON documents point inside it
 GoProControl gp(GOPRO_SSID, GOPRO_PASS, CAMERA);
 
 void setup()
@@ -16,7 +17,12 @@ void setup()
 void compute_status()
 {
   // Deserialize the JSON document
-  DeserializationError error = deserializeJson(status, gp.getStatus());
+  if (gp.getStatus(answer, sizeof(answer)) == 0)
+  {
+    Serial.println("getStatus() failed");
+    return;
+  }
+  DeserializationError error = deserializeJson(status, answer);
 
   // Test if parsing succeeds.
   if (error)
@@ -47,7 +53,12 @@ void compute_status()
 void compute_mediaList()
 {
   // Deserialize the JSON document
-  DeserializationError error = deserializeJson(media, gp.getMediaList());
+  if (gp.getMediaList(answer, sizeof(answer)) == 0)
+  {
+    Serial.println("getMediaList() failed");
+    return;
+  }
+  DeserializationError error = deserializeJson(media, answer);
 
   // Test if parsing succeeds.
   if (error)
@@ -0,0 +1,59 @@
+#include <GoProControl.h>
+#include "Secrets.h"
+
+/*
+  Take a picture every 5 seconds without stopping loop() while the camera
+  answers, the LED keeps blinking at its pace
+  edit the file Secrets.h with your camera netword name and password
+  CAMERA could be: HERO3, HERO4, HERO5, HERO6, HERO7, FUSION, HERO8, MAX
+*/
+
+#define CAMERA HERO5 // Change here for your camera
+
+GoProControl gp(GOPRO_SSID, GOPRO_PASS, CAMERA);
+
+bool connected = false;
+uint32_t last_shot = 0;
+uint32_t last_blink = 0;
+
+void onConnected(void *context, const GoProResult &result)
+{
+  connected = result.code == 200;
+  Serial.println(connected ? "Connected" : "Connection failed");
+}
+
+void onShot(void *context, const GoProResult &result)
+{
+  Serial.print("Shot ");
+  Serial.print(result.handle);
+  Serial.print(": code ");
+  Serial.print(result.code);
+  Serial.print(" in ");
+  Serial.print(result.latency);
+  Serial.println(" us");
+}
+
+void setup()
+{
+  Serial.begin(115200);
+  pinMode(LED_BUILTIN, OUTPUT);
+  gp.setPersistentConnection(true); // the connection is the only step that blocks
+  gp.beginAsync(onConnected);
+}
+
+void loop()
+{
+  gp.poll();
+
+  if (connected && millis() - last_shot > 5000)
+  {
+    last_shot = millis();
+    gp.shootAsync(onShot);
+  }
+
+  if (millis() - last_blink > 100)
+  {
+    last_blink = millis();
+    digitalWrite(LED_BUILTIN, !digitalRead(LED_BUILTIN));
+  }
+}
@@ -0,0 +1,8 @@
+#ifndef SECRETS_H
+#define SECRETS_H
+
+// Replace the following:
+#define GOPRO_SSID "__YOUR_CAMERA_NAME__"
+#define GOPRO_PASS "__YOUR_CAMERA_PASS__"
+
+#endif
@@ -1,16 +1,32 @@
 #include <GoProControl.h>
+#include <GoProWorker.h>
 #include "Secrets.h"
 
 /*
   Example with the FreeRTOS framework
+  A GoProWorker runs a task pinned to core 0 which is the only one to talk with
+  the camera: loop() (and any other task) posts the commands to it and gets the
+  results with poll(), the worker keeps the camera alive by itself
 */
 
 GoProControl gp(GOPRO_SSID, GOPRO_PASS, CAMERA);
+GoProWorker worker(gp);
+
+void onResult(void *context, const GoProResult &result)
+{
+  Serial.print("Command ");
+  Serial.print(result.handle);
+  Serial.print(": code ");
+  Serial.print(result.code);
+  Serial.print(" in ");
+  Serial.print(result.latency);
+  Serial.println(" us");
+}
 
 void setup()
 {
   gp.enableDebug(&Serial);
-  xTaskCreate(keep_alive, "keep_alive", 10000, NULL, 1, NULL);
+  worker.begin();
 }
 
 void loop()
@@ -28,106 +44,101 @@ void loop()
 
   // Connect
   case 'C':
-    gp.begin();
+    worker.connect(onResult);
     break;
 
   // Turn on and off
   case 'T':
-    gp.turnOn();
+    worker.turnOn(onResult);
     break;
 
   case 't':
-    gp.turnOff();
+    worker.turnOff(onResult);
     break;
 
   // Take a picture of start a video
   case 'A':
-    gp.shoot();
+    worker.shoot(onResult);
     break;
 
   // Stop the video
   case 'S':
-    gp.stopShoot();
+    worker.stopShoot(onResult);
     break;
 
   // Set modes
   case 'V':
-    gp.setMode(VIDEO_MODE);
+    worker.setMode(VIDEO_MODE, onResult);
     break;
 
   case 'P':
-    gp.setMode(PHOTO_MODE);
+    worker.setMode(PHOTO_MODE, onResult);
     break;
 
   case 'M':
-    gp.setMode(MULTISHOT_MODE);
+    worker.setMode(MULTISHOT_MODE, onResult);
     break;
 
   // Change the orientation
   case 'u':
-    gp.setOrientation(ORIENTATION_UP);
+    worker.setOrientation(ORIENTATION_UP, onResult);
     break;
 
   case 'd':
-    gp.setOrientation(ORIENTATION_DOWN);
+    worker.setOrientation(ORIENTATION_DOWN, onResult);
     break;
 
   // Change other parameters
   case 'W':
-    gp.setVideoFov(MEDIUM_FOV);
+    worker.setSetting(MEDIUM_FOV, onResult);
     break;
 
   case 'E':
-    gp.setFrameRate(FR_120);
+    worker.setSetting(FR_120, onResult);
     break;
 
   case 'f':
-    gp.setPhotoResolution(PR_11MP_WIDE);
+    worker.setSetting(PR_11MP_WIDE, onResult);
     break;
 
   case 'F':
-    gp.setVideoResolution(VR_1080p);
+    worker.setSetting(VR_1080p, onResult);
     break;
 
   case 'L':
-    gp.setTimeLapseInterval(60);
+    worker.setTimeLapseInterval(60, onResult);
     break;
 
   // Localize the camera
   case 'O':
-    gp.localizationOn();
+    worker.localizationOn(onResult);
     break;
 
   case 'I':
-    gp.localizationOff();
+    worker.localizationOff(onResult);
     break;
 
   // Delete some files, be carefull!
   case 'l':
-    gp.deleteLast();
+    worker.deleteLast(onResult);
     break;
 
   case 'D':
-    gp.deleteAll();
+    worker.deleteAll(onResult);
     break;
 
-  // Print useful data
+  // Print useful data, nothing is sent to the camera
   case 'p':
     gp.printStatus();
     break;
 
-  // Close the connection
+  // Close the connection, the worker must be stopped first
   case 'X':
+    worker.end();
     gp.end();
+    worker.begin();
     break;
   }
-}
 
-void keep_alive(void *parameter)
-{
-  while (1)
-  {
-    gp.keepAlive();
-  }
-  vTaskDelete(NULL);
+  worker.poll(); // the callbacks run here
 }
@@ -1,26 +1,37 @@
 #include <GoProControl.h>
+#include <GoProFleet.h>
 #include "Secrets.h"
 
 /*
-  Control two or more GoPro
+  Control two or more GoPro, the shutter of every camera is pressed at the
+  same time by GoProFleet
 */
 
 GoProControl Hero_Four(GOPRO_1_SSID, GOPRO_1_PASS, YOUR_CAMERA_1);
 GoProControl Hero_Seven(GOPRO_2_SSID, GOPRO_2_PASS, YOUR_CAMERA_2);
+GoProFleet fleet;
 
 void setup()
 {
+  Serial.begin(115200);
   Hero_Seven.enableDebug(&Serial);
   Hero_Four.enableDebug(&Serial);
 
   Hero_Four.begin();
   Hero_Seven.begin();
+
+  fleet.add(Hero_Four);
+  fleet.add(Hero_Seven);
+  fleet.arm(); // open the connections now, not when we shoot
 }
 
 void loop()
 {
-  Hero_Four.shoot();
-  delay(1000);
-  Hero_Seven.shoot();
-  delay(500);
+  if (fleet.shoot())
+  {
+    // how far apart the cameras started, in microseconds
+    Serial.print("Skew: ");
+    Serial.println(fleet.skew());
+  }
+  delay(1500);
 }
@@ -0,0 +1,800 @@
+/*
+Benchmark.cpp - per command latency of GoProControl against a MockCamera
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/*
+  Runs every public command of GoProControl many times against a MockCamera
+  and prints the p50/p99 latency of each one.
+
+  Usage: gopro_benchmark [--camera 3..10] [--iterations N] [--latency us]
+                         [--media files] [--rtt us] [--write-latency us]
+                         [--trail us] [--persistent] [--drop N]
+                         [--fleet cameras] [--file bytes] [--connections N]
+                         [--preview ms] [--preview-file capture.ts] [--metrics]
+                         [--scan ms] [--dhcp ms] [--wake ms] [--hang ms] [--csv]
+
+  The fleet rows give the time between the first and the last camera to
+  acknowledge the shutter, with GoProFleet and with shoot() called on one
+  camera after the other. On a HERO4 and newer the live preview is received
+  for --preview milliseconds, synthetic or replayed from a captured transport
+  stream, and its packet statistics are printed at the end. --metrics prints
+  what GoProControl measured by itself, as a table and as JSON. The boot lines
+  compare the first begin() of a board, which scans for --scan and waits for
+  DHCP for --dhcp milliseconds, with the next one from the stored link. The
+  power on line wakes a camera which boots for --wake milliseconds.
+  --write-latency adds to every write() of a client the round trip of an
+  AT+CIPSEND to an ESP01, the client writes are counted at the end. --trail
+  delays the rest of every answer after its status line, the (early) rows
+  return on the status line with setEarlyCompletion(true). The hung status
+  rows queue a shutter behind a status request which the camera never
+  answers, its first byte deadline is --hang milliseconds, and cancel() it;
+  the connect deadline line opens a connection which never completes.
+*/
+
+#include <GoProControl.h>
+#include <GoProFleet.h>
+#include <GoProOffload.h>
+#include <GoProPreview.h>
+#include <GoProWorker.h>
+#include "MockCamera.h"
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+#define MOCK_SSID "GP-MOCK"
+#define MOCK_PASS "goprohero"
+#define BOOT_JOIN_MS 40 // authentication and association, paid by every begin()
+#define WAKES 3
+#define HUNG_RUNS 20 // every run waits for a deadline
+
+struct Command
+{
+  const char *name;
+  std::function<bool()> run;
+};
+
+struct Result
+{
+  const char *name;
+  uint32_t runs;
+  uint32_t ok;
+  uint32_t p50;
+  uint32_t p99;
+  uint32_t max;
+};
+
+struct Pending
+{
+  bool done;
+  uint16_t code;
+};
+
+static void onResult(void *context, const GoProResult &result)
+{
+  Pending *pending = (Pending *)context;
+  pending->done = true;
+  pending->code = result.code;
+}
+
+static uint32_t percentile(const std::vector<uint32_t> &sorted, const double p)
+{
+  size_t index = (size_t)(p * sorted.size());
+  return sorted[std::min(index, sorted.size() - 1)];
+}
+
+static Result summary(const char *name, std::vector<uint32_t> &samples, const uint32_t ok)
+{
+  std::sort(samples.begin(), samples.end());
+  return {name, (uint32_t)samples.size(), ok, percentile(samples, 0.50),
+          percentile(samples, 0.99), samples.back()};
+}
+
+static Result measure(const Command &command, const uint32_t iterations,
+                      const std::function<void()> &settle)
+{
+  std::vector<uint32_t> samples;
+  samples.reserve(iterations);
+  uint32_t ok = 0;
+
+  for (uint32_t i = 0; i < iterations; i++)
+  {
+    auto start = std::chrono::steady_clock::now();
+    ok += command.run() ? 1 : 0;
+    auto stop = std::chrono::steady_clock::now();
+    samples.push_back(
+        (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(stop - start).count());
+    settle();
+  }
+  return summary(command.name, samples, ok);
+}
+
+#if GOPRO_ASYNC_SLOTS > 0 // the fleet triggers through the async queue
+// Skew of the shutter of many cameras: fleet.shoot() against shoot() on one
+// camera after the other, both on connections which are already open
+static void measureFleet(const uint8_t camera, const uint8_t cameras, const uint32_t latency_us,
+                         const uint32_t iterations, std::vector<Result> &results)
+{
+  std::vector<std::unique_ptr<MockCamera>> mocks;
+  std::vector<std::unique_ptr<GoProControl>> gopros;
+  GoProFleet fleet;
+  for (uint8_t i = 0; i < cameras; i++)
+  {
+    // start() routes port 80 to the new mock: connect before the next one
+    mocks.emplace_back(new MockCamera(camera, MOCK_PASS));
+    gopros.emplace_back(new GoProControl(MOCK_SSID, MOCK_PASS, camera));
+    mocks[i]->setLatency(latency_us);
+    if (!mocks[i]->start() || gopros[i]->begin() != true || !fleet.add(*gopros[i]))
+    {
+      fprintf(stderr, "unable to start camera %u of the fleet\n", i);
+      return;
+    }
+    gopros[i]->setPersistentConnection(true);
+    gopros[i]->openConnection();
+  }
+  fleet.arm();
+
+  std::vector<uint32_t> skews;
+  uint32_t ok = 0;
+  for (uint32_t i = 0; i < iterations; i++)
+  {
+    ok += fleet.shoot() ? 1 : 0;
+    skews.push_back(fleet.skew());
+  }
+  results.push_back(summary("fleet skew", skews, ok));
+
+  skews.clear();
+  ok = 0;
+  for (uint32_t i = 0; i < iterations; i++)
+  {
+    auto first = std::chrono::steady_clock::now();
+    auto last = first;
+    bool all = true;
+    for (uint8_t c = 0; c < cameras; c++)
+    {
+      all = gopros[c]->shoot() && all;
+      last = std::chrono::steady_clock::now();
+      if (c == 0)
+      {
+        first = last;
+      }
+    }
+    ok += all ? 1 : 0;
+    skews.push_back(
+        (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(last - first).count());
+  }
+  results.push_back(summary("sequential skew", skews, ok));
+
+  fleet.end();
+  for (uint8_t i = 0; i < cameras; i++)
+  {
+    gopros[i]->end();
+    mocks[i]->stop();
+  }
+}
+#endif
+
+int main(int argc, char **argv)
+{
+  uint8_t camera = HERO7;
+  uint32_t iterations = 2000;
+  uint32_t latency_us = 0;
+  uint32_t rtt_us = 0;
+  uint32_t write_us = 0;
+  uint32_t trail_us = 0;
+  uint16_t media = 4;
+  bool persistent = false;
+  uint16_t drop_after = 0;
+  uint8_t fleet = 3;
+  uint32_t file_size = 256 * 1024;
+  uint8_t connections = 4;
+  uint32_t preview_ms = 1000;
+  const char *preview_file = nullptr;
+#if GOPRO_METRICS
+  bool print_metrics = false;
+#endif
+  uint32_t scan_ms = 600;
+  uint32_t dhcp_ms = 300;
+  uint32_t wake_ms = 800;
+  uint32_t hang_ms = 50;
+  bool csv = false;
+
+  for (int i = 1; i < argc; i++)
+  {
+    std::string arg = argv[i];
+    if (arg == "--camera" && i + 1 < argc)
+    {
+      camera = atoi(argv[++i]);
+    }
+    else if (arg == "--iterations" && i + 1 < argc)
+    {
+      iterations = atoi(argv[++i]);
+    }
+    else if (arg == "--latency" && i + 1 < argc)
+    {
+      latency_us = atoi(argv[++i]);
+    }
+    else if (arg == "--media" && i + 1 < argc)
+    {
+      media = atoi(argv[++i]);
+    }
+    else if (arg == "--rtt" && i + 1 < argc)
+    {
+      rtt_us = atoi(argv[++i]);
+    }
+    else if (arg == "--write-latency" && i + 1 < argc)
+    {
+      write_us = atoi(argv[++i]);
+    }
+    else if (arg == "--trail" && i + 1 < argc)
+    {
+      trail_us = atoi(argv[++i]);
+    }
+    else if (arg == "--persistent")
+    {
+      persistent = true;
+    }
+    else if (arg == "--drop" && i + 1 < argc)
+    {
+      drop_after = atoi(argv[++i]);
+    }
+    else if (arg == "--fleet" && i + 1 < argc)
+    {
+      fleet = atoi(argv[++i]);
+    }
+    else if (arg == "--file" && i + 1 < argc)
+    {
+      file_size = atoi(argv[++i]);
+    }
+    else if (arg == "--connections" && i + 1 < argc)
+    {
+      connections = atoi(argv[++i]);
+    }
+    else if (arg == "--preview" && i + 1 < argc)
+    {
+      preview_ms = atoi(argv[++i]);
+    }
+    else if (arg == "--preview-file" && i + 1 < argc)
+    {
+      preview_file = argv[++i];
+    }
+    else if (arg == "--metrics")
+    {
+#if GOPRO_METRICS
+      print_metrics = true;
+#endif
+    }
+    else if (arg == "--scan" && i + 1 < argc)
+    {
+      scan_ms = atoi(argv[++i]);
+    }
+    else if (arg == "--dhcp" && i + 1 < argc)
+    {
+      dhcp_ms = atoi(argv[++i]);
+    }
+    else if (arg == "--wake" && i + 1 < argc)
+    {
+      wake_ms = atoi(argv[++i]);
+    }
+    else if (arg == "--hang" && i + 1 < argc)
+    {
+      hang_ms = atoi(argv[++i]);
+    }
+    else if (arg == "--csv")
+    {
+      csv = true;
+    }
+    else
+    {
+      fprintf(stderr,
+              "usage: %s [--camera 3..10] [--iterations N] [--latency us] [--media files] "
+              "[--rtt us] [--write-latency us] [--trail us] [--persistent] [--drop N] "
+              "[--fleet cameras] "
+              "[--file bytes] [--connections N] [--preview ms] [--preview-file capture.ts] [--metrics] "
+              "[--scan ms] [--dhcp ms] [--wake ms] [--hang ms] [--csv]\n",
+              argv[0]);
+      return 1;
+    }
+  }
+  if (camera < HERO3 || camera > MAX || iterations == 0 || fleet > GOPRO_FLEET_SIZE ||
+      connections == 0 || connections > GOPRO_OFFLOAD_CONNECTIONS)
+  {
+    fprintf(stderr, "invalid camera, iterations, fleet or connections\n");
+    return 1;
+  }
+
+  HostNetwork::setConnectLatency(rtt_us);
+  HostNetwork::setWriteLatency(write_us);
+  MockCamera mock(camera, MOCK_PASS);
+  mock.setLatency(latency_us);
+  mock.setTrailLatency(trail_us);
+  mock.setMediaCount(media);
+  mock.setDropAfter(drop_after);
+  mock.setFileSize(file_size);
+  if (preview_file != nullptr && !mock.setPreviewFile(preview_file))
+  {
+    fprintf(stderr, "unable to read %s\n", preview_file);
+    return 1;
+  }
+  if (!mock.start())
+  {
+    fprintf(stderr, "unable to start the mock camera\n");
+    return 1;
+  }
+
+  // a board which wakes from deep sleep: the first boot stores the link, the
+  // second one joins with it
+  HostNetwork::setAssociationLatency(scan_ms * 1000, BOOT_JOIN_MS * 1000, dhcp_ms * 1000);
+  eraseLink();
+  GoProBootTiming boots[2] = {};
+  bool booted = true;
+  for (GoProBootTiming &boot : boots)
+  {
+    GoProControl rig(MOCK_SSID, MOCK_PASS, camera);
+    rig.setFastConnect(true);
+    booted = rig.begin() == true && booted;
+    boot = rig.bootTiming();
+    rig.end();
+  }
+  booted = booted && !boots[0].fast && boots[1].fast;
+  HostNetwork::setAssociationLatency(0, 0, 0);
+  eraseLink();
+
+  GoProControl gp(MOCK_SSID, MOCK_PASS, camera);
+  gp.setPersistentConnection(persistent);
+  if (gp.begin() != true)
+  {
+    fprintf(stderr, "begin() failed\n");
+    return 1;
+  }
+
+  // a file of the mock SD card written to disk, one stream against many
+  GoProOffload offload(MOCK_SSID, MOCK_PASS, camera);
+  const std::string offload_path = "/tmp/gopro_benchmark_" + std::to_string(getpid()) + ".MP4";
+  const std::string offload_name = "offload (" + std::to_string(connections) + " connections)";
+  auto offloadFile = [&](const uint8_t streams, const uint32_t size) {
+    GoProOffloadResult result;
+    return offload.download("100GOPRO", "GOPR0002.MP4", offload_path.c_str(), streams,
+                            &result) == true &&
+           result.size == size;
+  };
+
+  // the packets go to the callback straight from the ring
+  GoProPreview preview(gp);
+  uint32_t longest_preview_poll = 0;
+  uint32_t preview_sent = 0;
+  const bool previewed = camera >= HERO4 && preview_ms > 0 &&
+                         preview.begin([](void *, const uint8_t *, uint16_t) {}) == true;
+  if (previewed)
+  {
+    const uint32_t start = millis();
+    while (millis() - start < preview_ms)
+    {
+      auto begin = std::chrono::steady_clock::now();
+      preview.poll();
+      auto end = std::chrono::steady_clock::now();
+      longest_preview_poll = std::max(
+          longest_preview_poll,
+          (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count());
+      yield();
+    }
+    preview.end();
+    preview_sent = mock.previewSent();
+  }
+
+  // an asynchronous command is polled until its callback, the longest poll()
+  // is the longest time loop() would be stalled
+  uint32_t longest_poll = 0;
+#if GOPRO_ASYNC_SLOTS > 0
+  auto async = [&](const std::function<uint8_t(Pending *)> &start) {
+    Pending pending = {false, 0};
+    if (start(&pending) == 0)
+    {
+      return false;
+    }
+    while (!pending.done)
+    {
+      auto begin = std::chrono::steady_clock::now();
+      gp.poll();
+      auto end = std::chrono::steady_clock::now();
+      longest_poll = std::max(
+          longest_poll,
+          (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count());
+      yield(); // the rest of loop()
+    }
+    return pending.code == 200;
+  };
+#endif
+
+  // the command returns on the status line, the rest of the answer is read
+  // by poll() between the runs, as loop() would
+  auto early = [&](const std::function<bool()> &command) {
+    gp.setEarlyCompletion(true);
+    const bool ok = command();
+    gp.setEarlyCompletion(false);
+    return ok;
+  };
+
+  std::vector<Command> commands = {
+      {"shoot", [&] { return gp.shoot(); }},
+      {"stopShoot", [&] { return gp.stopShoot(); }},
+      {"shoot (early)", [&] { return early([&] { return gp.shoot(); }); }},
+      {"stopShoot (early)", [&] { return early([&] { return gp.stopShoot(); }); }},
+      {"setMode", [&] { return gp.setMode(VIDEO_MODE) == true; }},
+      {"setOrientation", [&] { return gp.setOrientation(ORIENTATION_UP) == true; }},
+      {"setVideoResolution", [&] { return gp.setVideoResolution(VR_1080p) == true; }},
+      {"setSetting", [&] { return gp.setSetting(VR_1080p) == true; }},
+      {"setVideoFov", [&] { return gp.setVideoFov(WIDE_FOV) == true; }},
+      {"applyProfile",
+       [&] {
+         // the same options of the rows above: only the status goes out
+         GoProProfile profile;
+         profile.settings[SETTING_MODE] = VIDEO_MODE;
+         profile.settings[SETTING_VIDEO_RESOLUTION] = VR_1080p;
+         profile.settings[SETTING_VIDEO_FOV] = WIDE_FOV;
+         int8_t saved;
+         return gp.applyProfile(profile, saved) == true;
+       }},
+      {"setFrameRate", [&] { return gp.setFrameRate(FR_30) == true; }},
+      {"setVideoEncoding", [&] { return gp.setVideoEncoding(NTSC) == true; }},
+      {"setPhotoResolution",
+       [&] { return gp.setPhotoResolution(camera == HERO3 ? PR_11MP_WIDE : PR_12MP_WIDE) == true; }},
+      {"setTimeLapseInterval", [&] { return gp.setTimeLapseInterval(1) == true; }},
+      // only HERO3 has it, the others must refuse it without a request
+      {"setContinuousShot",
+       [&] {
+         const uint8_t result = gp.setContinuousShot(3);
+         return camera == HERO3 ? result == true : result == (uint8_t)-1;
+       }},
+      {"localizationOn", [&] { return gp.localizationOn(); }},
+      {"localizationOff", [&] { return gp.localizationOff(); }},
+      {"deleteLast", [&] { return gp.deleteLast(); }},
+      {"deleteAll", [&] { return gp.deleteAll(); }},
+      {"confirmPairing", [&] { return gp.confirmPairing(); }},
+      {"isOn", [&] { return gp.isOn(); }},
+#if !GOPRO_LOW_RAM // the copies need the whole answer in the response buffer
+      {"getStatus",
+       [&] {
+         char *status = gp.getStatus();
+         bool ok = status != nullptr;
+         free(status);
+         return ok;
+       }},
+#endif
+      {"getStatus (buffer)",
+       [&] {
+         static char status[MAX_RESPONSE_LEN];
+         return gp.getStatus(status, sizeof(status)) > 0;
+       }},
+      {"getStatus (typed)",
+       [&] {
+         GoProStatus status;
+         return gp.getStatus(status) == true;
+       }},
+      {"getStatus (cached)",
+       [&] {
+         GoProStatus status;
+         gp.setStatusCache(60000);
+         bool ok = gp.getStatus(status) == true;
+         gp.setStatusCache(0);
+         return ok;
+       }},
+#if !GOPRO_LOW_RAM
+      {"getMediaList",
+       [&] {
+         char *list = gp.getMediaList();
+         bool ok = list != nullptr;
+         free(list);
+         return ok;
+       }},
+#endif
+      {"listMedia",
+       [&] {
+         uint32_t files = 0;
+         GoProMediaFilter videos = {MEDIA_VIDEO, 0};
+         bool ok = gp.listMedia([](void *context, const GoProMediaFile &) { (*(uint32_t *)context)++; },
+                                &files, &videos);
+         uint32_t expected = 0; // the mock lists an MP4 on every odd entry but the bursts
+         for (uint16_t i = 0; i < media; i++)
+         {
+           expected += i % 7 != 6 && i % 2 ? 1 : 0;
+         }
+         return ok && files == expected;
+       }},
+      {"downloadMedia",
+       [&] {
+         GoProDownload download = {0, 0, 0, 0, 0, 0};
+         bool ok = gp.downloadMedia("100GOPRO", "GOPR0002.MP4",
+                                    [](void *, uint32_t, const uint8_t *, uint16_t) { return true; },
+                                    nullptr, &download);
+         return ok && download.received == file_size;
+       }},
+      {"offload (1 connection)", [&] { return offloadFile(1, file_size); }},
+      {offload_name.c_str(), [&] { return offloadFile(connections, file_size); }},
+      {"1 byte offload",
+       [&] {
+         // only the probe, there is nothing left for the other connections
+         mock.setFileSize(1);
+         const bool ok = offloadFile(connections, 1);
+         mock.setFileSize(file_size);
+         return ok;
+       }},
+#if GOPRO_ASYNC_SLOTS > 0
+      {"shootAsync", [&] { return async([&](Pending *p) { return gp.shootAsync(onResult, p); }); }},
+      {"shootAsync (early)",
+       [&] {
+         return early([&] { return async([&](Pending *p) { return gp.shootAsync(onResult, p); }); });
+       }},
+      {"setModeAsync",
+       [&] { return async([&](Pending *p) { return gp.setModeAsync(VIDEO_MODE, onResult, p); }); }},
+      {"getStatusAsync",
+       [&] { return async([&](Pending *p) { return gp.getStatusAsync(onResult, p); }); }},
+      {"beginAsync",
+       [&] {
+         // the association again, its slot has no request
+         gp.end();
+         return async([&](Pending *p) { return gp.beginAsync(onResult, p); }) && gp.isConnected();
+       }},
+#endif
+      {"turnOff", [&] { return gp.turnOff(true); }},
+      {"turnOn", [&] { return gp.turnOn(); }},
+  };
+
+  std::vector<Result> results;
+  for (const Command &command : commands)
+  {
+    // the power commands leave the camera in a known state before the next run
+    std::function<void()> settle = [&] {
+      while (gp.isBusy())
+      {
+        gp.poll();
+        yield();
+      }
+    };
+    if (strcmp(command.name, "turnOff") == 0)
+    {
+      settle = [&] {
+        gp.turnOn();
+        while (!mock.isPowered())
+        {
+          delay(1);
+        }
+      };
+    }
+    else if (strcmp(command.name, "turnOn") == 0)
+    {
+      settle = [&] {
+        while (!mock.isPowered())
+        {
+          delay(1);
+        }
+        gp.turnOff(true);
+      };
+    }
+    results.push_back(measure(command, iterations, settle));
+  }
+  // the same shutter posted to the I/O task of a GoProWorker, from the post to
+  // the callback given by poll()
+  gp.turnOn();
+  while (!mock.isPowered())
+  {
+    delay(1);
+  }
+#if GOPRO_ASYNC_SLOTS > 0
+  {
+    GoProWorker worker(gp);
+    worker.begin();
+    results.push_back(measure({"shoot (worker)",
+                               [&] {
+                                 Pending pending = {false, 0};
+                                 if (worker.shoot(onResult, &pending) == 0)
+                                 {
+                                   return false;
+                                 }
+                                 while (!pending.done)
+                                 {
+                                   worker.poll();
+                                   yield();
+                                 }
+                                 return pending.code == 200;
+                               }},
+                              iterations, [] {}));
+    worker.end();
+  }
+#endif
+#if GOPRO_ASYNC_SLOTS > 0
+  // a status request the camera never answers: the shutter queued behind it
+  // waits for its first byte deadline, or goes at once after cancel()
+  {
+    const GoProDeadlines saved = gp.deadlines(METRIC_STATUS);
+    GoProDeadlines hung = saved;
+    hung.first_byte = hang_ms;
+    hung.body = 2 * hang_ms;
+    gp.setDeadlines(hung, METRIC_STATUS);
+    mock.setHang(camera >= HERO4 ? "gpControl/status" : "/camera/sx");
+    const uint32_t runs = std::min<uint32_t>(iterations, HUNG_RUNS);
+
+    results.push_back(measure({"shoot behind hung status",
+                               [&] {
+                                 Pending status = {false, 0};
+                                 gp.getStatusAsync(onResult, &status);
+                                 const bool ok = async(
+                                     [&](Pending *p) { return gp.shootAsync(onResult, p); });
+                                 return ok && status.done && gp.expired() == DEADLINE_NONE;
+                               }},
+                              runs, [] {}));
+    results.push_back(measure({"shoot after cancel()",
+                               [&] {
+                                 Pending status = {false, 0};
+                                 gp.getStatusAsync(onResult, &status);
+                                 gp.poll(); // sent, waiting for the answer
+                                 gp.cancel(); // acted on by the next poll()
+                                 const bool ok = async(
+                                     [&](Pending *p) { return gp.shootAsync(onResult, p); });
+                                 return ok && status.done;
+                               }},
+                              runs, [] {}));
+    mock.setHang(nullptr);
+    gp.setDeadlines(saved, METRIC_STATUS);
+  }
+#endif
+  // a sleeping camera which boots for wake_ms and is busy for a quarter of it
+  // more, a single magic packet of every burst is lost
+  std::vector<uint32_t> wakes;
+  const uint32_t wol_before = mock.wolPackets();
+  if (camera >= HERO4)
+  {
+    mock.setBootTime(wake_ms, wake_ms / 4);
+    mock.setWoLLoss(WOL_BURST);
+    for (uint8_t i = 0; i < WAKES; i++)
+    {
+      mock.setPowered(false);
+      uint32_t ready;
+      if (gp.powerOn(ready) == true)
+      {
+        wakes.push_back(ready);
+      }
+    }
+    mock.setBootTime(0);
+    mock.setWoLLoss(0);
+  }
+  const uint32_t wol_packets = mock.wolPackets() - wol_before;
+
+#if GOPRO_ASYNC_SLOTS > 0
+  if (fleet > 1)
+  {
+    measureFleet(camera, fleet, latency_us, iterations, results);
+  }
+#endif
+
+  // a camera which holds the TCP handshake for a second: the shutter gives up
+  // at its connect deadline. The camera counts as lost afterwards, it is last
+  gp.setPersistentConnection(false);
+  GoProDeadlines quick = gp.deadlines(METRIC_SHUTTER);
+  quick.connect = hang_ms;
+  gp.setDeadlines(quick, METRIC_SHUTTER);
+  HostNetwork::setConnectLatency(1000000);
+  const uint32_t connect_start = millis();
+  gp.shoot();
+  const uint32_t connect_ms = millis() - connect_start;
+  const bool connect_expired = gp.expired() == DEADLINE_CONNECT;
+  HostNetwork::setConnectLatency(rtt_us);
+
+  if (csv)
+  {
+    printf("command,runs,ok,p50_us,p99_us,max_us\n");
+    for (const Result &r : results)
+    {
+      printf("%s,%u,%u,%u,%u,%u\n", r.name, r.runs, r.ok, r.p50, r.p99, r.max);
+    }
+  }
+  else
+  {
+    printf("camera %u, %u iterations, mock latency %u us, rtt %u us, %u media files, %s "
+           "connection\n\n",
+           camera, iterations, latency_us, rtt_us, media, persistent ? "persistent" : "one-shot");
+    printf("%-24s %8s %8s %10s %10s %10s\n", "command", "runs", "ok", "p50 us", "p99 us",
+           "max us");
+    for (const Result &r : results)
+    {
+      printf("%-24s %8u %8u %10u %10u %10u\n", r.name, r.runs, r.ok, r.p50, r.p99, r.max);
+    }
+    const GoProFootprint footprint = GoProControl::footprint();
+    printf("\nGoProControl %u bytes: response %u, request %u, async %u, status %u, "
+           "metrics %u, link %u, sockets %u, no heap\n",
+           footprint.total, footprint.response, footprint.request, footprint.async,
+           footprint.status, footprint.metrics, footprint.link, footprint.sockets);
+    printf("requests %u, connections %u, client writes %u, WoL packets %u, keep-alives %u, "
+           "longest poll() %u us\n",
+           mock.requests(), mock.connections(), HostNetwork::clientWrites(), mock.wolPackets(),
+           mock.keepAlives(), longest_poll);
+    for (const Result &r : results)
+    {
+      if ((strcmp(r.name, "downloadMedia") == 0 || strncmp(r.name, "offload", 7) == 0) &&
+          r.p50 > 0)
+      {
+        printf("%s of %u bytes: %.1f MB/s at p50\n", r.name, file_size,
+               (double)file_size / r.p50);
+      }
+    }
+    if (camera >= HERO4)
+    {
+      std::sort(wakes.begin(), wakes.end());
+      printf("power on (%u ms boot): %zu of %u ready, %u to %u ms, %u WoL packets\n", wake_ms,
+             wakes.size(), WAKES, wakes.empty() ? 0 : wakes.front(),
+             wakes.empty() ? 0 : wakes.back(), wol_packets);
+    }
+    for (uint8_t i = 0; i < 2; i++)
+    {
+      const GoProBootTiming &boot = boots[i];
+      printf("boot %s: %u us (load %u, directed %u, full %u, save %u)%s\n",
+             i == 0 ? "full association" : "stored link", boot.total, boot.load,
+             boot.directed, boot.full, boot.save, booted ? "" : " FAILED");
+    }
+    printf("connect deadline (%u ms): shoot gave up after %u ms%s\n", hang_ms, connect_ms,
+           connect_expired ? "" : " FAILED");
+    if (previewed)
+    {
+      const GoProPreviewStats &stats = preview.stats();
+      printf("preview %u ms: %u of %u datagrams, %u bytes, %u dropped, %u out of order, "
+             "%u late, longest poll() %u us\n",
+             preview_ms, stats.packets, preview_sent, stats.bytes, stats.dropped,
+             stats.out_of_order, stats.late, longest_preview_poll);
+    }
+  }
+
+#if GOPRO_METRICS
+  if (print_metrics && !csv)
+  {
+    // the upper bound of the bucket of the percentile
+    const GoProMetrics &metrics = gp.metrics();
+    printf("\n%-10s %8s %12s %12s %12s %12s %12s %6s %9s\n", "metrics", "requests",
+           "connect p50", "send p50", "1st byte p50", "total p50", "total p99", "late",
+           "cancelled");
+    for (uint8_t i = 0; i < metric_commands; i++)
+    {
+      const GoProCommandMetrics &command = metrics.commands[i];
+      if (command.requests > 0)
+      {
+        printf("%-10s %8u %9u us %9u us %9u us %9u us %9u us %6u %9u\n", metricName(i),
+               command.requests, command.connect.percentile(50), command.send.percentile(50),
+               command.first_byte.percentile(50), command.total.percentile(50),
+               command.total.percentile(99),
+               command.late_connect + command.late_first_byte + command.late_body,
+               command.cancelled);
+      }
+    }
+    static char json[4096];
+    if (metricsJson(metrics, json, sizeof(json)) > 0)
+    {
+      printf("%s\n", json);
+    }
+  }
+#endif
+
+  unlink(offload_path.c_str());
+  gp.end();
+  mock.stop();
+  return 0;
+}
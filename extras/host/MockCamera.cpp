@@ -0,0 +1,959 @@
+/*
+MockCamera.cpp - loopback stand-in for a GoPro camera, used by the host build
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "MockCamera.h"
+
+#include <HostNetwork.h>
+#include <StatusParser.h>
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#define HERO3_BLOCK_LEN 56
+#define PREVIEW_DATAGRAM_LEN (7 * 188)
+#define PREVIEW_PID 0x1011
+#define PREVIEW_TIMEOUT_MS 10000 // the stream stops without keep-alives
+
+static int listenSocket(const int type, uint16_t &port)
+{
+  int fd = socket(AF_INET, type, 0);
+  if (fd < 0)
+  {
+    return -1;
+  }
+  int one = 1;
+  setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+  sockaddr_in address;
+  memset(&address, 0, sizeof(address));
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  address.sin_port = 0;
+  socklen_t address_len = sizeof(address);
+  if (bind(fd, (sockaddr *)&address, sizeof(address)) != 0 ||
+      (type == SOCK_STREAM && listen(fd, 64) != 0) ||
+      getsockname(fd, (sockaddr *)&address, &address_len) != 0)
+  {
+    close(fd);
+    return -1;
+  }
+  port = ntohs(address.sin_port);
+  return fd;
+}
+
+static bool sendAll(const int fd, const char *data, size_t len)
+{
+  while (len > 0)
+  {
+    ssize_t n = send(fd, data, len, MSG_NOSIGNAL);
+    if (n <= 0)
+    {
+      return false;
+    }
+    data += n;
+    len -= n;
+  }
+  return true;
+}
+
+// Value of a query parameter, "" if missing
+static std::string queryParam(const std::string &path, const char *name)
+{
+  const std::string key = std::string(name) + "=";
+  size_t query = path.find('?');
+  while (query != std::string::npos)
+  {
+    if (path.compare(query + 1, key.size(), key) == 0)
+    {
+      size_t start = query + 1 + key.size();
+      size_t end = path.find('&', start);
+      return path.substr(start, end == std::string::npos ? std::string::npos : end - start);
+    }
+    query = path.find('&', query + 1);
+  }
+  return "";
+}
+
+static const char *reason(const uint16_t code)
+{
+  switch (code)
+  {
+  case 200:
+    return "OK";
+  case 206:
+    return "Partial Content";
+  case 400:
+    return "Bad Request";
+  case 403:
+    return "Forbidden";
+  case 404:
+    return "Not Found";
+  case 410:
+    return "Gone";
+  case 416:
+    return "Range Not Satisfiable";
+  default:
+    return "Error";
+  }
+}
+
+////////////////////////////////////////////////////////////
+////////                 Lifecycle                 /////////
+////////////////////////////////////////////////////////////
+
+MockCamera::MockCamera(const uint8_t camera, const char *password)
+    : _camera(camera), _password(password)
+{
+  memcpy(_mac, HostNetwork::getBSSID(), sizeof(_mac));
+
+  // HERO4 and newer defaults: 1080p, 30 fps, wide FOV, orientation up
+  for (int id = 1; id <= 121; id++)
+  {
+    _settings[id] = 0;
+  }
+  _settings[2] = 9;
+  _settings[3] = 8;
+}
+
+MockCamera::~MockCamera()
+{
+  stop();
+}
+
+bool MockCamera::start()
+{
+  if (_running)
+  {
+    return true;
+  }
+  _http_fd = listenSocket(SOCK_STREAM, _http_port);
+  _media_fd = listenSocket(SOCK_STREAM, _media_port);
+  _wol_fd = listenSocket(SOCK_DGRAM, _wol_port);
+  _preview_fd = listenSocket(SOCK_DGRAM, _preview_port);
+  if (_http_fd < 0 || _media_fd < 0 || _wol_fd < 0 || _preview_fd < 0)
+  {
+    stop();
+    return false;
+  }
+
+  _running = true;
+  _http_thread = std::thread(&MockCamera::acceptLoop, this, _http_fd, false);
+  _media_thread = std::thread(&MockCamera::acceptLoop, this, _media_fd, true);
+  _udp_thread = std::thread(&MockCamera::udpLoop, this);
+  _preview_thread = std::thread(&MockCamera::previewLoop, this);
+  route();
+  return true;
+}
+
+void MockCamera::stop()
+{
+  _running = false;
+  for (int *fd : {&_http_fd, &_media_fd, &_wol_fd, &_preview_fd})
+  {
+    if (*fd >= 0)
+    {
+      shutdown(*fd, SHUT_RDWR);
+    }
+  }
+  for (std::thread *t : {&_http_thread, &_media_thread, &_udp_thread, &_preview_thread})
+  {
+    if (t->joinable())
+    {
+      t->join();
+    }
+  }
+  for (int *fd : {&_http_fd, &_media_fd, &_wol_fd, &_preview_fd})
+  {
+    if (*fd >= 0)
+    {
+      close(*fd);
+      *fd = -1;
+    }
+  }
+
+  // the connection workers are detached, wait for the last one to leave
+  std::unique_lock<std::mutex> guard(_workers_lock);
+  for (int fd : _worker_fds)
+  {
+    shutdown(fd, SHUT_RDWR);
+  }
+  _workers_done.wait(guard, [this] { return _worker_fds.empty(); });
+}
+
+void MockCamera::route()
+{
+  HostNetwork::mapPort(80, _http_port);
+  HostNetwork::mapPort(8080, _media_port);
+  HostNetwork::mapPort(9, _wol_port);
+  HostNetwork::mapPort(8554, _preview_port);
+}
+
+void MockCamera::setLatency(const uint32_t latency_us)
+{
+  _latency_us = latency_us;
+}
+
+void MockCamera::setTrailLatency(const uint32_t latency_us)
+{
+  _trail_us = latency_us;
+}
+
+void MockCamera::setHang(const char *fragment)
+{
+  std::lock_guard<std::mutex> guard(_state_lock);
+  _hang = fragment != nullptr ? fragment : "";
+}
+
+bool MockCamera::hangs(const std::string &path)
+{
+  std::lock_guard<std::mutex> guard(_state_lock);
+  return !_hang.empty() && path.find(_hang) != std::string::npos;
+}
+
+void MockCamera::setMediaCount(const uint16_t files)
+{
+  _media_count = files;
+}
+
+void MockCamera::setPowered(const bool powered)
+{
+  _powered = powered;
+}
+
+void MockCamera::setBootTime(const uint32_t boot_ms, const uint32_t busy_ms)
+{
+  _boot_ms = boot_ms;
+  _busy_ms = busy_ms;
+}
+
+void MockCamera::setWoLLoss(const uint16_t every)
+{
+  _wol_loss = every;
+}
+
+bool MockCamera::isPowered() const
+{
+  return _powered && (!_woken || millis() - _woke_at >= _boot_ms);
+}
+
+bool MockCamera::isBusy() const
+{
+  return _woken && millis() - _woke_at < _boot_ms + _busy_ms;
+}
+
+void MockCamera::setDropAfter(const uint16_t requests)
+{
+  _drop_after = requests;
+}
+
+void MockCamera::setFileSize(const uint32_t bytes)
+{
+  _file_size = bytes;
+}
+
+void MockCamera::setDownloadDrop(const uint32_t bytes)
+{
+  _download_drop = bytes;
+}
+
+bool MockCamera::setPreviewFile(const char *path)
+{
+  FILE *file = fopen(path, "rb");
+  if (file == nullptr)
+  {
+    return false;
+  }
+  std::vector<uint8_t> content;
+  uint8_t block[4096];
+  size_t n;
+  while ((n = fread(block, 1, sizeof(block), file)) > 0)
+  {
+    content.insert(content.end(), block, block + n);
+  }
+  fclose(file);
+
+  std::lock_guard<std::mutex> guard(_preview_lock);
+  _preview_file.swap(content);
+  _preview_pos = 0;
+  return !_preview_file.empty();
+}
+
+void MockCamera::setPreviewRate(const uint16_t packets_per_second)
+{
+  _preview_rate = packets_per_second > 0 ? packets_per_second : 1;
+}
+
+void MockCamera::setPreviewLoss(const uint16_t every)
+{
+  _preview_loss = every;
+}
+
+void MockCamera::setPreviewReorder(const uint16_t every)
+{
+  _preview_reorder = every;
+}
+
+////////////////////////////////////////////////////////////
+////////                  Network                  /////////
+////////////////////////////////////////////////////////////
+
+void MockCamera::acceptLoop(const int listen_fd, const bool media)
+{
+  while (_running)
+  {
+    int fd = accept(listen_fd, nullptr, nullptr);
+    if (fd < 0)
+    {
+      continue; // woken up by stop()
+    }
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    _connections++;
+
+    std::lock_guard<std::mutex> guard(_workers_lock);
+    _worker_fds.push_back(fd);
+    std::thread(&MockCamera::serve, this, fd, media).detach();
+  }
+}
+
+void MockCamera::udpLoop()
+{
+  uint8_t packet[1500];
+  pollfd fds = {_wol_fd, POLLIN, 0};
+
+  while (_running)
+  {
+    if (poll(&fds, 1, 50) <= 0)
+    {
+      continue;
+    }
+    ssize_t n = recv(_wol_fd, packet, sizeof(packet), MSG_DONTWAIT);
+    if (n != 6 + 16 * 6)
+    {
+      continue;
+    }
+    bool valid = true;
+    for (uint8_t i = 0; i < 6 && valid; i++)
+    {
+      valid = packet[i] == 0xFF;
+    }
+    for (uint8_t i = 0; i < 16 && valid; i++)
+    {
+      valid = memcmp(packet + 6 + i * 6, _mac, 6) == 0;
+    }
+    if (valid)
+    {
+      _wol_packets++;
+      if (_wol_loss > 0 && _wol_packets % _wol_loss == 0)
+      {
+        continue; // lost in the air
+      }
+      if (!_powered)
+      {
+        _woke_at = millis();
+        _woken = true;
+        _powered = true;
+      }
+    }
+  }
+}
+
+void MockCamera::previewLoop()
+{
+  char packet[1500];
+  pollfd fds = {_preview_fd, POLLIN, 0};
+  std::vector<uint8_t> datagram;
+  std::vector<uint8_t> held; // waiting to be sent after the next one
+  uint32_t next_send = micros();
+
+  while (_running)
+  {
+    int32_t wait_ms = 50;
+    if (_streaming)
+    {
+      const int32_t until = (int32_t)(next_send - micros()) / 1000;
+      wait_ms = until < 0 ? 0 : (until < wait_ms ? until : wait_ms);
+    }
+    else
+    {
+      next_send = micros(); // the first datagram goes at once
+    }
+    if (poll(&fds, 1, wait_ms) > 0)
+    {
+      ssize_t n = recv(_preview_fd, packet, sizeof(packet), MSG_DONTWAIT);
+      if (n >= 6 && memcmp(packet, "_GPHD_", 6) == 0)
+      {
+        _keep_alives++;
+        std::lock_guard<std::mutex> guard(_preview_lock);
+        _preview_heard = millis();
+      }
+      continue;
+    }
+    if (!_streaming || (int32_t)(next_send - micros()) > 0)
+    {
+      continue;
+    }
+    next_send += 1000000 / _preview_rate;
+
+    const uint16_t board_port = HostNetwork::boardPort(8554);
+    {
+      std::lock_guard<std::mutex> guard(_preview_lock);
+      if (millis() - _preview_heard > PREVIEW_TIMEOUT_MS || !previewPacket(datagram))
+      {
+        _streaming = false;
+        continue;
+      }
+    }
+    const uint32_t index = ++_preview_sent;
+    if (board_port == 0 || (_preview_loss > 0 && index % _preview_loss == 0))
+    {
+      continue;
+    }
+    if (_preview_reorder > 0 && index % _preview_reorder == 0 && held.empty())
+    {
+      held.swap(datagram);
+      continue;
+    }
+
+    sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons(board_port);
+    sendto(_preview_fd, datagram.data(), datagram.size(), 0, (sockaddr *)&address, sizeof(address));
+    if (!held.empty())
+    {
+      sendto(_preview_fd, held.data(), held.size(), 0, (sockaddr *)&address, sizeof(address));
+      held.clear();
+    }
+  }
+}
+
+void MockCamera::restartPreview()
+{
+  std::lock_guard<std::mutex> guard(_preview_lock);
+  _preview_pos = 0;
+  _preview_counter = 0;
+  _preview_heard = millis(); // the stream waits for the first keep-alive
+  _streaming = true;
+}
+
+bool MockCamera::previewPacket(std::vector<uint8_t> &packet)
+{
+  if (!_preview_file.empty())
+  {
+    if (_preview_pos >= _preview_file.size())
+    {
+      return false; // a capture is played once
+    }
+    const size_t len = std::min<size_t>(PREVIEW_DATAGRAM_LEN, _preview_file.size() - _preview_pos);
+    packet.assign(_preview_file.begin() + _preview_pos, _preview_file.begin() + _preview_pos + len);
+    _preview_pos += len;
+    return true;
+  }
+
+  // 7 transport stream packets of a single PID, with the payload only
+  packet.resize(PREVIEW_DATAGRAM_LEN);
+  for (uint16_t i = 0; i < PREVIEW_DATAGRAM_LEN; i += 188)
+  {
+    uint8_t *ts = packet.data() + i;
+    ts[0] = 0x47;
+    ts[1] = PREVIEW_PID >> 8;
+    ts[2] = PREVIEW_PID & 0xFF;
+    ts[3] = 0x10 | _preview_counter;
+    memset(ts + 4, _preview_counter, 184);
+    _preview_counter = (_preview_counter + 1) & 0x0F;
+  }
+  return true;
+}
+
+void MockCamera::serve(const int fd, const bool media)
+{
+  std::string pending;
+  char chunk[2048];
+  uint16_t served = 0;
+
+  while (_running)
+  {
+    size_t header_end;
+    while ((header_end = pending.find("\r\n\r\n")) == std::string::npos)
+    {
+      ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+      if (n <= 0)
+      {
+        // the keep alive of HERO4 and newer is a bare line sent to port 80
+        if (pending.compare(0, 6, "_GPHD_") == 0)
+        {
+          _keep_alives++;
+        }
+        header_end = std::string::npos;
+        break;
+      }
+      pending.append(chunk, n);
+    }
+    if (header_end == std::string::npos)
+    {
+      break;
+    }
+
+    const std::string head = pending.substr(0, header_end);
+    pending.erase(0, header_end + 4);
+
+    size_t path_start = head.find(' ');
+    size_t path_end = head.find(' ', path_start + 1);
+    if (path_start == std::string::npos || path_end == std::string::npos)
+    {
+      break;
+    }
+    std::string path = head.substr(path_start + 1, path_end - path_start - 1);
+    if (path.empty() || path[0] != '/')
+    {
+      path.insert(0, "/");
+    }
+    const bool close_after = head.find("Connection: close") != std::string::npos;
+
+    if (!isPowered() && !(media == false && _camera == HERO3))
+    {
+      break; // a sleeping camera accepts the connection but never answers
+    }
+    _requests++;
+    if (hangs(path))
+    {
+      while (_running && recv(fd, chunk, sizeof(chunk), 0) > 0)
+      {
+      }
+      break;
+    }
+    if (_latency_us > 0)
+    {
+      delayMicroseconds(_latency_us);
+    }
+
+    if (media && path.compare(0, 13, "/videos/DCIM/") == 0)
+    {
+      served++;
+      if (!serveFile(fd, head, close_after) || close_after)
+      {
+        break;
+      }
+      continue;
+    }
+
+    Response response = handle(path, media);
+    char header[256];
+    int header_len = snprintf(header, sizeof(header),
+                              "HTTP/1.1 %u %s\r\n"
+                              "Content-Type: %s\r\n"
+                              "Content-Length: %zu\r\n"
+                              "Connection: %s\r\n\r\n",
+                              response.code, reason(response.code), response.type.c_str(),
+                              response.body.size(), close_after ? "close" : "keep-alive");
+    std::string out(header, header_len);
+    out += response.body;
+    served++;
+    size_t sent = 0;
+    if (_trail_us > 0)
+    {
+      sent = out.find("\r\n") + 2; // the status line goes first
+      if (!sendAll(fd, out.data(), sent))
+      {
+        break;
+      }
+      delayMicroseconds(_trail_us);
+    }
+    if (!sendAll(fd, out.data() + sent, out.size() - sent) || close_after ||
+        (_drop_after > 0 && served >= _drop_after))
+    {
+      break;
+    }
+  }
+
+  std::lock_guard<std::mutex> guard(_workers_lock);
+  for (size_t i = 0; i < _worker_fds.size(); i++)
+  {
+    if (_worker_fds[i] == fd)
+    {
+      _worker_fds.erase(_worker_fds.begin() + i);
+      break;
+    }
+  }
+  close(fd);
+  _workers_done.notify_all();
+}
+
+// A file of the SD card, generated while it is sent, with the Range header
+bool MockCamera::serveFile(const int fd, const std::string &head, const bool close_after)
+{
+  const uint32_t size = _file_size;
+  uint32_t first = 0;
+  uint32_t last = size - 1;
+  const size_t range = head.find("Range: bytes=");
+  if (range != std::string::npos)
+  {
+    sscanf(head.c_str() + range + 13, "%u-%u", &first, &last);
+    last = std::min(last, size - 1);
+  }
+
+  char header[256];
+  int header_len;
+  const char *connection = close_after ? "close" : "keep-alive";
+  if (first > last)
+  {
+    header_len = snprintf(header, sizeof(header),
+                          "HTTP/1.1 416 %s\r\nContent-Range: bytes */%u\r\n"
+                          "Content-Length: 0\r\nConnection: %s\r\n\r\n",
+                          reason(416), size, connection);
+    return sendAll(fd, header, header_len);
+  }
+  if (range != std::string::npos)
+  {
+    header_len = snprintf(header, sizeof(header),
+                          "HTTP/1.1 206 %s\r\nContent-Type: video/mp4\r\n"
+                          "Content-Range: bytes %u-%u/%u\r\nContent-Length: %u\r\n"
+                          "Connection: %s\r\n\r\n",
+                          reason(206), first, last, size, last - first + 1, connection);
+  }
+  else
+  {
+    header_len = snprintf(header, sizeof(header),
+                          "HTTP/1.1 200 %s\r\nContent-Type: video/mp4\r\n"
+                          "Content-Length: %u\r\nConnection: %s\r\n\r\n",
+                          reason(200), size, connection);
+  }
+  if (!sendAll(fd, header, header_len))
+  {
+    return false;
+  }
+
+  const uint32_t drop = _download_drop;
+  uint8_t block[65536];
+  uint32_t sent = 0;
+  for (uint32_t position = first; position <= last;)
+  {
+    uint32_t len = std::min<uint32_t>(sizeof(block), last - position + 1);
+    if (drop > 0 && sent + len > drop)
+    {
+      len = drop - sent;
+    }
+    for (uint32_t i = 0; i < len; i++)
+    {
+      block[i] = fileByte(position + i);
+    }
+    if (!sendAll(fd, (const char *)block, len))
+    {
+      return false;
+    }
+    position += len;
+    sent += len;
+    if (drop > 0 && sent == drop && position <= last)
+    {
+      return false; // the WiFi dropped in the middle of the file
+    }
+  }
+  return true;
+}
+
+////////////////////////////////////////////////////////////
+////////                    API                    /////////
+////////////////////////////////////////////////////////////
+
+MockCamera::Response MockCamera::handle(const std::string &path, const bool media)
+{
+  if (media)
+  {
+    if (path.compare(0, 15, "/gp/gpMediaList") == 0)
+    {
+      return {200, "application/json", mediaListJson()};
+    }
+    return {404, "text/plain", ""};
+  }
+  std::lock_guard<std::mutex> guard(_state_lock);
+  return _camera == HERO3 ? handleHero3(path) : handleHero4(path);
+}
+
+MockCamera::Response MockCamera::handleHero3(const std::string &path)
+{
+  // /bacpac/XX?t=password&p=%NN or /camera/XX?t=password&p=%NN
+  if (queryParam(path, "t") != _password)
+  {
+    return {403, "text/plain", ""};
+  }
+  size_t command_start = path.find('/', 1) + 1;
+  const std::string command = path.substr(command_start, 2);
+  const std::string p = queryParam(path, "p");
+  const int value = p.size() > 1 ? strtol(p.c_str() + 1, nullptr, 16) : -1;
+  const bool bacpac = path.compare(0, 8, "/bacpac/") == 0;
+
+  if (bacpac && command == "PW")
+  {
+    _powered = value == 1;
+    return {200, "text/plain", ""};
+  }
+  if (!_powered)
+  {
+    return {410, "text/plain", ""};
+  }
+  if (command == "sx")
+  {
+    return {200, "application/octet-stream", statusHero3()};
+  }
+  if (command == "SH")
+  {
+    if (value == 1 && _mode == 0)
+    {
+      _recording = true;
+    }
+    else if (value == 1)
+    {
+      _photos++;
+    }
+    else if (_recording)
+    {
+      _recording = false;
+      _videos++;
+    }
+    return {200, "text/plain", ""};
+  }
+  if (command == "CM")
+  {
+    _mode = value;
+  }
+  else if (command == "TI" || command == "FV" || command == "PR" || command == "VR" ||
+           command == "FS")
+  {
+    _hero3_settings[command] = value;
+  }
+  else if (command == "DL" && _photos + _videos > 0)
+  {
+    _photos > 0 ? _photos-- : _videos--;
+  }
+  else if (command == "DA")
+  {
+    _photos = _videos = 0;
+  }
+  return {200, "text/plain", ""};
+}
+
+MockCamera::Response MockCamera::handleHero4(const std::string &path)
+{
+  static const char prefix[] = "/gp/gpControl/";
+  if (path.compare(0, sizeof(prefix) - 1, prefix) != 0)
+  {
+    return {404, "text/plain", ""};
+  }
+  const std::string api = path.substr(sizeof(prefix) - 1);
+
+  if (api == "status")
+  {
+    return {200, "application/json", statusJson()};
+  }
+  if (api.compare(0, 8, "setting/") == 0)
+  {
+    int id = 0, value = 0;
+    if (sscanf(api.c_str(), "setting/%d/%d", &id, &value) != 2 || id < 1 || id > 121)
+    {
+      return {400, "application/json", "{}"};
+    }
+    _settings[id] = value;
+    return {200, "application/json", "{}"};
+  }
+  if (api.compare(0, 15, "command/shutter") == 0)
+  {
+    if (queryParam(api, "p") == "1")
+    {
+      if (_mode == 0)
+      {
+        _recording = true;
+      }
+      else
+      {
+        _photos++;
+      }
+    }
+    else if (_recording)
+    {
+      _recording = false;
+      _videos++;
+    }
+    return {200, "application/json", "{}"};
+  }
+  if (api.compare(0, 13, "command/mode?") == 0)
+  {
+    _mode = atoi(queryParam(api, "p").c_str());
+    _sub_mode = 0;
+    return {200, "application/json", "{}"};
+  }
+  if (api.compare(0, 17, "command/sub_mode?") == 0)
+  {
+    _mode = atoi(queryParam(api, "mode").c_str());
+    _sub_mode = atoi(queryParam(api, "sub_mode").c_str());
+    return {200, "application/json", "{}"};
+  }
+  if (api == "command/system/sleep")
+  {
+    _powered = false;
+    _recording = false;
+    return {200, "application/json", "{}"};
+  }
+  if (api == "command/storage/delete/last")
+  {
+    if (_photos + _videos > 0)
+    {
+      _photos > 0 ? _photos-- : _videos--;
+    }
+    return {200, "application/json", "{}"};
+  }
+  if (api == "command/storage/delete/all")
+  {
+    _photos = _videos = 0;
+    return {200, "application/json", "{}"};
+  }
+  if (api == "execute?p1=gpStream&c1=restart")
+  {
+    restartPreview();
+    return {200, "application/json", "{}"};
+  }
+  if (api.compare(0, 22, "command/system/locate?") == 0 ||
+      api.compare(0, 30, "command/wireless/pair/complete") == 0 ||
+      api.compare(0, 8, "execute?") == 0)
+  {
+    return {200, "application/json", "{}"};
+  }
+  return {404, "text/plain", ""};
+}
+
+////////////////////////////////////////////////////////////
+////////                  Payloads                 /////////
+////////////////////////////////////////////////////////////
+
+std::string MockCamera::statusJson()
+{
+  std::map<int, std::string> status;
+  for (int id = 1; id <= 74; id++)
+  {
+    status[id] = "0";
+  }
+  status[1] = "1";                                    // internal battery present
+  status[2] = "3";                                    // battery level
+  status[8] = isBusy() ? "1" : "0";                   // busy
+  status[10] = _recording ? "1" : "0";                // encoding
+  status[29] = "\"\"";                                // wifi ssid of the remote
+  status[30] = "\"GP00000000\"";                      // camera ssid
+  status[31] = "1";                                   // connected clients
+  status[33] = "0";                                   // SD card ok
+  status[34] = std::to_string(9999 - _photos);        // remaining photos
+  status[35] = std::to_string(5400);                  // remaining video seconds
+  status[38] = std::to_string(_photos);               // photos on the card
+  status[39] = std::to_string(_videos);               // videos on the card
+  status[40] = "\"%12%0A%13%0D%2B%2A\"";              // date
+  status[43] = std::to_string(_mode);                 // mode
+  status[44] = std::to_string(_sub_mode);             // sub mode
+  status[54] = "30765056";                            // remaining bytes
+  status[70] = "87";                                  // battery percentage
+
+  std::string json = "{\"status\":{";
+  for (auto &field : status)
+  {
+    json += "\"" + std::to_string(field.first) + "\":" + field.second + ",";
+  }
+  json.back() = '}';
+  json += ",\"settings\":{";
+  for (auto &field : _settings)
+  {
+    json += "\"" + std::to_string(field.first) + "\":" + std::to_string(field.second) + ",";
+  }
+  json.back() = '}';
+  json += "}";
+  return json;
+}
+
+// 56 byte binary block of /camera/sx, see HERO3_STATUS_* in StatusParser.h
+std::string MockCamera::statusHero3()
+{
+  std::string block(HERO3_BLOCK_LEN, '\0');
+  block[HERO3_STATUS_POWER] = _powered ? 0 : 1;
+  block[HERO3_STATUS_MODE] = _mode;
+  block[HERO3_STATUS_TIME_LAPSE] = _hero3_settings["TI"];
+  block[HERO3_STATUS_VIDEO_FOV] = _hero3_settings["FV"];
+  block[HERO3_STATUS_PHOTO_RESOLUTION] = _hero3_settings["PR"];
+  block[HERO3_STATUS_BATTERY] = 87;
+  block[HERO3_STATUS_REMAINING_PHOTOS] = 0x12;
+  block[HERO3_STATUS_REMAINING_PHOTOS + 1] = 0x34;
+  block[HERO3_STATUS_PHOTOS] = _photos >> 8;
+  block[HERO3_STATUS_PHOTOS + 1] = _photos & 0xFF;
+  block[HERO3_STATUS_REMAINING_VIDEO + 1] = 95;
+  block[HERO3_STATUS_VIDEOS] = _videos >> 8;
+  block[HERO3_STATUS_VIDEOS + 1] = _videos & 0xFF;
+  block[HERO3_STATUS_RECORDING] = _recording ? 1 : 0;
+  block[HERO3_STATUS_VIDEO_RESOLUTION] = _hero3_settings["VR"];
+  block[HERO3_STATUS_FRAME_RATE] = _hero3_settings["FS"];
+  return block;
+}
+
+std::string MockCamera::mediaListJson()
+{
+  const uint16_t files = _media_count;
+  std::string json = "{\"id\":\"1554375628411872255\",\"media\":[";
+
+  // 999 files per directory like the camera does
+  for (uint16_t dir = 0; dir == 0 || dir * 999 < files; dir++)
+  {
+    char name[32];
+    snprintf(name, sizeof(name), "%s{\"d\":\"%uGOPRO\",\"fs\":[", dir ? "," : "", 100 + dir);
+    json += name;
+    for (uint16_t i = dir * 999; i < files && i < (dir + 1) * 999; i++)
+    {
+      // a video, a photo and every seventh entry a burst with a deleted file
+      const uint32_t created = 1554375600u + i * 60;
+      char file[200];
+      if (i % 7 == 6)
+      {
+        snprintf(file, sizeof(file),
+                 "%s{\"b\":\"%u\",\"cre\":\"%u\",\"g\":\"%u\",\"l\":\"%u\",\"m\":[\"%u\"],"
+                 "\"mod\":\"%u\",\"n\":\"G%03u%04u.JPG\",\"s\":\"%u\",\"t\":\"b\"}",
+                 i % 999 ? "," : "", i + 1, created, i / 7 + 1, i + 30, i + 2, created + 30,
+                 i / 7 + 1, i + 1, 75000000u + i);
+      }
+      else if (i % 2)
+      {
+        snprintf(file, sizeof(file),
+                 "%s{\"n\":\"GOPR%04u.MP4\",\"cre\":\"%u\",\"mod\":\"%u\",\"glrv\":\"%u\","
+                 "\"ls\":\"-1\",\"s\":\"%u\"}",
+                 i % 999 ? "," : "", i + 1, created, created + 30, 4000000u + i, 48000000u + i);
+      }
+      else
+      {
+        snprintf(file, sizeof(file),
+                 "%s{\"n\":\"GOPR%04u.JPG\",\"cre\":\"%u\",\"mod\":\"%u\",\"s\":\"%u\"}",
+                 i % 999 ? "," : "", i + 1, created, created, 2500000u + i);
+      }
+      json += file;
+    }
+    json += "]}";
+  }
+  json += "]}";
+  return json;
+}
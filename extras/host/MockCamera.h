@@ -0,0 +1,192 @@
+/*
+MockCamera.h - loopback stand-in for a GoPro camera, used by the host build
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef MOCK_CAMERA_H
+#define MOCK_CAMERA_H
+
+#include <Arduino.h>
+#include <Settings.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Answers the HTTP API of a HERO3 (/bacpac/..., /camera/...) or of a HERO4 and
+// newer (/gp/gpControl/...) on port 80, the media list and the files
+// (/videos/DCIM/..., with Range) on port 8080, the WoL packets on port 9 and
+// the preview keep-alives on UDP port 8554. Every port is bound on 127.0.0.1
+// with an ephemeral number and published through HostNetwork with route()
+class MockCamera
+{
+public:
+  MockCamera(const uint8_t camera, const char *password = "");
+  ~MockCamera();
+
+  bool start();
+  void stop();
+  void route();
+
+  // Tuning
+  void setLatency(const uint32_t latency_us);
+  // Pause between the status line and the rest of every answer
+  void setTrailLatency(const uint32_t latency_us);
+  // Never answer the requests whose path holds fragment, as a camera which
+  // hangs on them: the connection stays open until the board closes it.
+  // nullptr answers every request
+  void setHang(const char *fragment);
+  void setMediaCount(const uint16_t files);
+  void setPowered(const bool powered);
+  // After a magic packet the camera answers only after boot_ms and says it is
+  // busy for busy_ms more, as a real one while it boots
+  void setBootTime(const uint32_t boot_ms, const uint32_t busy_ms = 0);
+  // Ignore every n-th magic packet, 0 never
+  void setWoLLoss(const uint16_t every);
+  // Silently close a keep-alive connection after this many requests, 0 never
+  void setDropAfter(const uint16_t requests);
+  // Every file of the SD card has this size, whatever the list says
+  void setFileSize(const uint32_t bytes);
+  // Close the connection after sending this many bytes of a file, 0 never
+  void setDownloadDrop(const uint32_t bytes);
+  // After a gpStream restart the preview is streamed to the UDP port 8554 of
+  // the board: a synthetic transport stream, or a captured one played once
+  bool setPreviewFile(const char *path);
+  void setPreviewRate(const uint16_t packets_per_second);
+  // Skip every n-th datagram, 0 never
+  void setPreviewLoss(const uint16_t every);
+  // Swap every n-th datagram with the next one, 0 never
+  void setPreviewReorder(const uint16_t every);
+
+  // Content of every file, to check what was downloaded
+  static uint8_t fileByte(const uint32_t position)
+  {
+    return position ^ (position >> 8) ^ (position >> 16);
+  }
+
+  // Introspection
+  uint16_t httpPort() const { return _http_port; }
+  uint16_t mediaPort() const { return _media_port; }
+  uint16_t wolPort() const { return _wol_port; }
+  uint16_t previewPort() const { return _preview_port; }
+  uint32_t requests() const { return _requests; }
+  uint32_t connections() const { return _connections; }
+  uint32_t wolPackets() const { return _wol_packets; }
+  uint32_t keepAlives() const { return _keep_alives; }
+  // Datagrams of the preview, the skipped ones included
+  uint32_t previewSent() const { return _preview_sent; }
+  bool isStreaming() const { return _streaming; }
+  // On and done booting
+  bool isPowered() const;
+  bool isRecording() const { return _recording; }
+
+private:
+  struct Response
+  {
+    uint16_t code;
+    std::string type;
+    std::string body;
+  };
+
+  const uint8_t _camera;
+  const std::string _password;
+  uint8_t _mac[6];
+
+  std::atomic<bool> _running{false};
+  std::atomic<uint32_t> _latency_us{0};
+  std::atomic<uint32_t> _trail_us{0};
+  std::atomic<uint16_t> _media_count{4};
+  std::atomic<uint16_t> _drop_after{0};
+  std::atomic<uint32_t> _file_size{1 << 20};
+  std::atomic<uint32_t> _download_drop{0};
+  std::atomic<uint16_t> _preview_rate{200};
+  std::atomic<uint16_t> _preview_loss{0};
+  std::atomic<uint16_t> _preview_reorder{0};
+  std::atomic<uint32_t> _boot_ms{0};
+  std::atomic<uint32_t> _busy_ms{0};
+  std::atomic<uint16_t> _wol_loss{0};
+
+  int _http_fd = -1;
+  int _media_fd = -1;
+  int _wol_fd = -1;
+  int _preview_fd = -1;
+  uint16_t _http_port = 0;
+  uint16_t _media_port = 0;
+  uint16_t _wol_port = 0;
+  uint16_t _preview_port = 0;
+
+  std::thread _http_thread;
+  std::thread _media_thread;
+  std::thread _udp_thread;
+  std::thread _preview_thread;
+  std::mutex _workers_lock;
+  std::condition_variable _workers_done;
+  std::vector<int> _worker_fds;
+
+  std::atomic<uint32_t> _requests{0};
+  std::atomic<uint32_t> _connections{0};
+  std::atomic<uint32_t> _wol_packets{0};
+  std::atomic<uint32_t> _keep_alives{0};
+  std::atomic<uint32_t> _preview_sent{0};
+
+  // Preview, guarded by _preview_lock
+  std::mutex _preview_lock;
+  std::atomic<bool> _streaming{false};
+  std::vector<uint8_t> _preview_file; // empty for the synthetic stream
+  size_t _preview_pos = 0;
+  uint8_t _preview_counter = 0;
+  uint32_t _preview_heard = 0; // millis() of the last keep-alive
+
+  // Camera state, guarded by _state_lock
+  std::mutex _state_lock;
+  std::atomic<bool> _powered{true};
+  std::atomic<bool> _woken{false};   // by a magic packet, not by setPowered()
+  std::atomic<uint32_t> _woke_at{0}; // millis() of that packet
+  std::atomic<bool> _recording{false};
+  uint8_t _mode = 0;
+  uint8_t _sub_mode = 0;
+  uint16_t _photos = 0;
+  uint16_t _videos = 0;
+  std::map<int, int> _settings;              // HERO4 and newer, by id
+  std::map<std::string, int> _hero3_settings; // HERO3, by command
+  std::string _hang;                          // empty: every request is answered
+
+  void acceptLoop(const int listen_fd, const bool media);
+  void udpLoop();
+  void previewLoop();
+  void restartPreview();
+  bool isBusy() const;
+  bool hangs(const std::string &path);
+  bool previewPacket(std::vector<uint8_t> &packet);
+  void serve(const int fd, const bool media);
+
+  Response handle(const std::string &path, const bool media);
+  Response handleHero3(const std::string &path);
+  Response handleHero4(const std::string &path);
+  std::string statusJson();
+  bool serveFile(const int fd, const std::string &head, const bool close_after);
+  std::string statusHero3();
+  std::string mediaListJson();
+};
+
+#endif // MOCK_CAMERA_H
@@ -0,0 +1,245 @@
+/*
+Arduino.cpp - minimal Arduino core for the host (Linux) build
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <Arduino.h>
+#include <Utilities.h>
+
+#include <arpa/inet.h>
+#include <chrono>
+#include <thread>
+
+HardwareSerial Serial;
+
+static const std::chrono::steady_clock::time_point boot_time = std::chrono::steady_clock::now();
+
+////////////////////////////////////////////////////////////
+////////                   Timing                  /////////
+////////////////////////////////////////////////////////////
+
+uint32_t millis()
+{
+  return (uint32_t)std::chrono::duration_cast<std::chrono::milliseconds>(
+             std::chrono::steady_clock::now() - boot_time)
+      .count();
+}
+
+uint32_t micros()
+{
+  return (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now() - boot_time)
+      .count();
+}
+
+void delay(uint32_t ms)
+{
+  std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+void delayMicroseconds(uint32_t us)
+{
+  std::this_thread::sleep_for(std::chrono::microseconds(us));
+}
+
+void yield()
+{
+  std::this_thread::yield();
+}
+
+////////////////////////////////////////////////////////////
+////////                   Print                   /////////
+////////////////////////////////////////////////////////////
+
+size_t Print::write(const uint8_t *buffer, size_t size)
+{
+  size_t n = 0;
+  while (size--)
+  {
+    n += write(*buffer++);
+  }
+  return n;
+}
+
+size_t Print::write(const char *str)
+{
+  return str == nullptr ? 0 : write((const uint8_t *)str, strlen(str));
+}
+
+size_t Print::printNumber(unsigned long n, uint8_t base)
+{
+  char buf[8 * sizeof(long) + 1];
+  char *str = &buf[sizeof(buf) - 1];
+  *str = '\0';
+  if (base < 2)
+  {
+    base = 10;
+  }
+  do
+  {
+    char c = n % base;
+    n /= base;
+    *--str = c < 10 ? c + '0' : c + 'A' - 10;
+  } while (n);
+  return write(str);
+}
+
+size_t Print::print(const __FlashStringHelper *str) { return write((const char *)str); }
+size_t Print::print(const char *str) { return write(str); }
+size_t Print::print(char c) { return write((uint8_t)c); }
+size_t Print::print(unsigned char n, int base) { return print((unsigned long)n, base); }
+size_t Print::print(int n, int base) { return print((long)n, base); }
+size_t Print::print(unsigned int n, int base) { return print((unsigned long)n, base); }
+
+size_t Print::print(long n, int base)
+{
+  if (base == DEC && n < 0)
+  {
+    return print('-') + printNumber(-(unsigned long)n, DEC);
+  }
+  return printNumber((unsigned long)n, base);
+}
+
+size_t Print::print(unsigned long n, int base) { return printNumber(n, base); }
+
+size_t Print::print(double n, int digits)
+{
+  char buf[48];
+  snprintf(buf, sizeof(buf), "%.*f", digits, n);
+  return write(buf);
+}
+
+size_t Print::print(const Printable &p) { return p.printTo(*this); }
+
+size_t Print::println() { return write("\r\n"); }
+size_t Print::println(const __FlashStringHelper *str) { return print(str) + println(); }
+size_t Print::println(const char *str) { return print(str) + println(); }
+size_t Print::println(char c) { return print(c) + println(); }
+size_t Print::println(unsigned char n, int base) { return print(n, base) + println(); }
+size_t Print::println(int n, int base) { return print(n, base) + println(); }
+size_t Print::println(unsigned int n, int base) { return print(n, base) + println(); }
+size_t Print::println(long n, int base) { return print(n, base) + println(); }
+size_t Print::println(unsigned long n, int base) { return print(n, base) + println(); }
+size_t Print::println(double n, int digits) { return print(n, digits) + println(); }
+size_t Print::println(const Printable &p) { return print(p) + println(); }
+
+////////////////////////////////////////////////////////////
+////////                 IPAddress                 /////////
+////////////////////////////////////////////////////////////
+
+IPAddress::IPAddress()
+{
+  memset(_address, 0, sizeof(_address));
+}
+
+IPAddress::IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d)
+{
+  _address[0] = a;
+  _address[1] = b;
+  _address[2] = c;
+  _address[3] = d;
+}
+
+IPAddress::IPAddress(uint32_t address)
+{
+  memcpy(_address, &address, sizeof(_address));
+}
+
+IPAddress::operator uint32_t() const
+{
+  uint32_t address;
+  memcpy(&address, _address, sizeof(address));
+  return address;
+}
+
+bool IPAddress::fromString(const char *address)
+{
+  in_addr parsed;
+  if (inet_pton(AF_INET, address, &parsed) != 1)
+  {
+    return false;
+  }
+  memcpy(_address, &parsed.s_addr, sizeof(_address));
+  return true;
+}
+
+size_t IPAddress::printTo(Print &p) const
+{
+  size_t n = 0;
+  for (uint8_t i = 0; i < 4; i++)
+  {
+    n += p.print(_address[i], DEC);
+    if (i < 3)
+    {
+      n += p.print('.');
+    }
+  }
+  return n;
+}
+
+////////////////////////////////////////////////////////////
+////////               HardwareSerial              /////////
+////////////////////////////////////////////////////////////
+
+void HardwareSerial::begin(uint32_t baudrate)
+{
+  (void)baudrate;
+}
+
+void HardwareSerial::end() {}
+
+int HardwareSerial::available() { return 0; }
+int HardwareSerial::read() { return -1; }
+int HardwareSerial::peek() { return -1; }
+
+size_t HardwareSerial::write(uint8_t c)
+{
+  return fwrite(&c, 1, 1, stdout);
+}
+
+size_t HardwareSerial::write(const uint8_t *buffer, size_t size)
+{
+  return fwrite(buffer, 1, size, stdout);
+}
+
+////////////////////////////////////////////////////////////
+////////                 Utilities                 /////////
+////////////////////////////////////////////////////////////
+
+int16_t stringSearch(const char *main_string, const char *to_search, int16_t start)
+{
+  if ((size_t)start > strlen(main_string))
+  {
+    return -1;
+  }
+  const char *found = strstr(main_string + start, to_search);
+  return found == nullptr ? -1 : (int16_t)(found - main_string);
+}
+
+char *stringCut(const char *main_string, int16_t from, int16_t to)
+{
+  if (from < 0 || to < from)
+  {
+    from = to = 0;
+  }
+  char *cut = (char *)malloc(to - from + 1);
+  memcpy(cut, main_string + from, to - from);
+  cut[to - from] = '\0';
+  return cut;
+}
@@ -0,0 +1,63 @@
+/*
+HostNetwork.h - routing of the camera address to the loopback interface
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef HOST_NETWORK_H
+#define HOST_NETWORK_H
+
+#include <Arduino.h>
+
+// Every address the library talks to (10.5.5.9, the broadcast address used by
+// the WoL packet) is sent to 127.0.0.1, the port is translated with the table
+// below so more than one fake camera can run without root privileges
+namespace HostNetwork
+{
+void mapPort(const uint16_t camera_port, const uint16_t local_port);
+uint16_t localPort(const uint16_t camera_port);
+void clearPorts();
+
+// WiFiUDP::begin() binds an ephemeral port, the number requested by the
+// library is kept here so a MockCamera knows where to send its datagrams
+void bindBoardPort(const uint16_t board_port, const uint16_t local_port);
+uint16_t boardPort(const uint16_t board_port);
+
+// Extra time spent by WiFiClient::connect(), stands for the TCP handshake
+// over the air which is almost free on the loopback interface
+void setConnectLatency(const uint32_t latency_us);
+uint32_t connectLatency();
+
+// Extra time spent by every WiFiClient::write(), stands for the round trip of
+// an AT+CIPSEND to an ESP01. The writes are counted
+void setWriteLatency(const uint32_t latency_us);
+uint32_t clientWrites();
+
+// Time taken by WiFi.begin(): scanning every channel, joining the camera and
+// asking an address to its DHCP server, all 0 by default
+void setAssociationLatency(const uint32_t scan_us, const uint32_t join_us,
+                           const uint32_t dhcp_us);
+uint32_t associationLatency(const bool scan, const bool dhcp);
+
+// BSSID reported by WiFi.BSSID(), must match the MAC a MockCamera expects in
+// the WoL packet
+void setBSSID(const uint8_t bssid[6]);
+const uint8_t *getBSSID();
+} // namespace HostNetwork
+
+#endif // HOST_NETWORK_H
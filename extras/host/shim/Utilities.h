@@ -0,0 +1,55 @@
+/*
+Utilities.h - host build replacement of the Utilities library (ID 6235)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef HOST_UTILITIES_H
+#define HOST_UTILITIES_H
+
+#include <Arduino.h>
+
+#define LEN(x) (sizeof(x) / sizeof((x)[0]))
+
+// Return the index of the first occurrence of to_search, -1 if not found
+int16_t stringSearch(const char *main_string, const char *to_search, int16_t start = 0);
+
+// Return a malloc'ed copy of main_string[from, to), the caller must free it
+char *stringCut(const char *main_string, int16_t from, int16_t to);
+
+template <typename T>
+void printArray(T array[], uint16_t array_length, const char *delimiter = ",",
+                uint8_t formatter = DEC, bool invert = false, bool new_line = true,
+                Print *port = &Serial)
+{
+  for (uint16_t i = 0; i < array_length; i++)
+  {
+    uint16_t index = invert ? array_length - i - 1 : i;
+    port->print(array[index], formatter);
+    if (i < array_length - 1)
+    {
+      port->print(delimiter);
+    }
+  }
+  if (new_line)
+  {
+    port->println();
+  }
+}
+
+#endif // HOST_UTILITIES_H
@@ -0,0 +1,529 @@
+/*
+WiFi.cpp - socket backed WiFi, WiFiClient and WiFiUDP for the host (Linux) build
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <WiFi.h>
+#include <WiFiUdp.h>
+
+#include <arpa/inet.h>
+#include <atomic>
+#include <errno.h>
+#include <map>
+#include <mutex>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+WiFiClass WiFi;
+
+////////////////////////////////////////////////////////////
+////////                HostNetwork                /////////
+////////////////////////////////////////////////////////////
+
+static std::mutex routes_lock;
+static std::map<uint16_t, uint16_t> routes;
+static std::map<uint16_t, uint16_t> board_ports;
+static uint32_t connect_latency_us = 0;
+static uint32_t write_latency_us = 0;
+static std::atomic<uint32_t> client_writes(0);
+static uint32_t scan_latency_us = 0;
+static uint32_t join_latency_us = 0;
+static uint32_t dhcp_latency_us = 0;
+static uint8_t host_bssid[6] = {0xD6, 0x32, 0x60, 0x00, 0x00, 0x01};
+#define HOST_CHANNEL 6
+
+void HostNetwork::mapPort(const uint16_t camera_port, const uint16_t local_port)
+{
+  std::lock_guard<std::mutex> guard(routes_lock);
+  routes[camera_port] = local_port;
+}
+
+uint16_t HostNetwork::localPort(const uint16_t camera_port)
+{
+  std::lock_guard<std::mutex> guard(routes_lock);
+  auto route = routes.find(camera_port);
+  return route == routes.end() ? camera_port : route->second;
+}
+
+void HostNetwork::clearPorts()
+{
+  std::lock_guard<std::mutex> guard(routes_lock);
+  routes.clear();
+  board_ports.clear();
+}
+
+void HostNetwork::bindBoardPort(const uint16_t board_port, const uint16_t local_port)
+{
+  std::lock_guard<std::mutex> guard(routes_lock);
+  board_ports[board_port] = local_port;
+}
+
+uint16_t HostNetwork::boardPort(const uint16_t board_port)
+{
+  std::lock_guard<std::mutex> guard(routes_lock);
+  auto bound = board_ports.find(board_port);
+  return bound == board_ports.end() ? 0 : bound->second;
+}
+
+void HostNetwork::setConnectLatency(const uint32_t latency_us)
+{
+  connect_latency_us = latency_us;
+}
+
+uint32_t HostNetwork::connectLatency()
+{
+  return connect_latency_us;
+}
+
+void HostNetwork::setWriteLatency(const uint32_t latency_us)
+{
+  write_latency_us = latency_us;
+}
+
+uint32_t HostNetwork::clientWrites()
+{
+  return client_writes;
+}
+
+void HostNetwork::setAssociationLatency(const uint32_t scan_us, const uint32_t join_us,
+                                        const uint32_t dhcp_us)
+{
+  scan_latency_us = scan_us;
+  join_latency_us = join_us;
+  dhcp_latency_us = dhcp_us;
+}
+
+uint32_t HostNetwork::associationLatency(const bool scan, const bool dhcp)
+{
+  return (scan ? scan_latency_us : 0) + join_latency_us + (dhcp ? dhcp_latency_us : 0);
+}
+
+void HostNetwork::setBSSID(const uint8_t bssid[6])
+{
+  memcpy(host_bssid, bssid, sizeof(host_bssid));
+}
+
+const uint8_t *HostNetwork::getBSSID()
+{
+  return host_bssid;
+}
+
+static sockaddr_in loopback(const uint16_t camera_port)
+{
+  sockaddr_in address;
+  memset(&address, 0, sizeof(address));
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  address.sin_port = htons(HostNetwork::localPort(camera_port));
+  return address;
+}
+
+////////////////////////////////////////////////////////////
+////////                    WiFi                   /////////
+////////////////////////////////////////////////////////////
+
+int WiFiClass::begin(const char *ssid, const char *pwd)
+{
+  return begin(ssid, pwd, 0, nullptr);
+}
+
+int WiFiClass::begin(const char *ssid, const char *pwd, int32_t channel, const uint8_t *bssid)
+{
+  (void)ssid;
+  (void)pwd;
+  if ((channel != 0 && channel != HOST_CHANNEL) ||
+      (bssid != nullptr && memcmp(bssid, HostNetwork::getBSSID(), 6) != 0))
+  {
+    _status = WL_NO_SSID_AVAIL; // the camera isn't there
+    return _status;
+  }
+  _joined_at = micros();
+  _join_us = HostNetwork::associationLatency(channel == 0, (uint32_t)_static_ip == 0);
+  _status = _join_us == 0 ? WL_CONNECTED : WL_DISCONNECTED;
+  return _status;
+}
+
+bool WiFiClass::config(IPAddress local, IPAddress gateway, IPAddress subnet)
+{
+  _static_ip = local;
+  _gateway = gateway;
+  _subnet = subnet;
+  return true;
+}
+
+int WiFiClass::disconnect()
+{
+  _status = WL_DISCONNECTED;
+  _join_us = 0;
+  return _status;
+}
+
+uint8_t WiFiClass::status()
+{
+  if (_status == WL_DISCONNECTED && _join_us != 0 && micros() - _joined_at >= _join_us)
+  {
+    _status = WL_CONNECTED;
+  }
+  return _status;
+}
+
+uint8_t *WiFiClass::BSSID(uint8_t *bssid)
+{
+  memcpy(bssid, HostNetwork::getBSSID(), 6);
+  return bssid;
+}
+
+int32_t WiFiClass::channel()
+{
+  return status() == WL_CONNECTED ? HOST_CHANNEL : 0;
+}
+
+uint8_t *WiFiClass::macAddress(uint8_t *mac)
+{
+  const uint8_t board_mac[6] = {0x02, 0x00, 0x00, 0x00, 0x00, 0x01};
+  memcpy(mac, board_mac, sizeof(board_mac));
+  return mac;
+}
+
+IPAddress WiFiClass::localIP()
+{
+  if (status() != WL_CONNECTED)
+  {
+    return IPAddress();
+  }
+  return (uint32_t)_static_ip != 0 ? _static_ip : IPAddress(10, 5, 5, 100);
+}
+
+IPAddress WiFiClass::gatewayIP()
+{
+  if (status() != WL_CONNECTED)
+  {
+    return IPAddress();
+  }
+  return (uint32_t)_static_ip != 0 ? _gateway : IPAddress(10, 5, 5, 9);
+}
+
+IPAddress WiFiClass::subnetMask()
+{
+  if (status() != WL_CONNECTED)
+  {
+    return IPAddress();
+  }
+  return (uint32_t)_static_ip != 0 ? _subnet : IPAddress(255, 255, 255, 0);
+}
+
+int32_t WiFiClass::RSSI()
+{
+  return status() == WL_CONNECTED ? -40 : 0;
+}
+
+////////////////////////////////////////////////////////////
+////////                 WiFiClient                /////////
+////////////////////////////////////////////////////////////
+
+WiFiClient::~WiFiClient()
+{
+  stop();
+}
+
+int WiFiClient::connect(const char *host, uint16_t port)
+{
+  return connect(host, port, -1);
+}
+
+int WiFiClient::connect(const char *host, uint16_t port, int32_t timeout_ms)
+{
+  (void)host; // every camera answers on the loopback interface
+  stop();
+
+  // the handshake over the air is the latency of setConnectLatency()
+  if (timeout_ms >= 0 && connect_latency_us > (uint32_t)timeout_ms * 1000)
+  {
+    delay(timeout_ms);
+    return 0;
+  }
+
+  _fd = socket(AF_INET, SOCK_STREAM, 0);
+  if (_fd < 0)
+  {
+    return 0;
+  }
+  int one = 1;
+  setsockopt(_fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+  sockaddr_in address = loopback(port);
+  if (::connect(_fd, (sockaddr *)&address, sizeof(address)) != 0)
+  {
+    stop();
+    return 0;
+  }
+  if (connect_latency_us > 0)
+  {
+    delayMicroseconds(connect_latency_us);
+  }
+  return 1;
+}
+
+int WiFiClient::connect(IPAddress ip, uint16_t port)
+{
+  (void)ip;
+  return connect("", port);
+}
+
+size_t WiFiClient::write(uint8_t c)
+{
+  return write(&c, 1);
+}
+
+size_t WiFiClient::write(const uint8_t *buffer, size_t size)
+{
+  if (_fd < 0)
+  {
+    return 0;
+  }
+  client_writes++;
+  if (write_latency_us > 0)
+  {
+    delayMicroseconds(write_latency_us);
+  }
+  size_t sent = 0;
+  while (sent < size)
+  {
+    ssize_t n = send(_fd, buffer + sent, size - sent, MSG_NOSIGNAL);
+    if (n <= 0)
+    {
+      return sent;
+    }
+    sent += n;
+  }
+  return sent;
+}
+
+int WiFiClient::available()
+{
+  if (_fd < 0)
+  {
+    return 0;
+  }
+  int pending = 0;
+  if (ioctl(_fd, FIONREAD, &pending) != 0)
+  {
+    return 0;
+  }
+  return pending;
+}
+
+int WiFiClient::read()
+{
+  uint8_t c;
+  return read(&c, 1) == 1 ? c : -1;
+}
+
+int WiFiClient::read(uint8_t *buffer, size_t size)
+{
+  if (_fd < 0)
+  {
+    return -1;
+  }
+  ssize_t n = recv(_fd, buffer, size, MSG_DONTWAIT);
+  return n > 0 ? (int)n : -1;
+}
+
+int WiFiClient::peek()
+{
+  uint8_t c;
+  if (_fd < 0 || recv(_fd, &c, 1, MSG_PEEK | MSG_DONTWAIT) != 1)
+  {
+    return -1;
+  }
+  return c;
+}
+
+void WiFiClient::stop()
+{
+  if (_fd >= 0)
+  {
+    close(_fd);
+    _fd = -1;
+  }
+}
+
+uint8_t WiFiClient::connected()
+{
+  if (_fd < 0)
+  {
+    return 0;
+  }
+  uint8_t c;
+  ssize_t n = recv(_fd, &c, 1, MSG_PEEK | MSG_DONTWAIT);
+  if (n > 0)
+  {
+    return 1;
+  }
+  if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+  {
+    return 1;
+  }
+  return 0; // closed by the peer or broken
+}
+
+////////////////////////////////////////////////////////////
+////////                  WiFiUDP                  /////////
+////////////////////////////////////////////////////////////
+
+WiFiUDP::~WiFiUDP()
+{
+  stop();
+}
+
+bool WiFiUDP::openSocket()
+{
+  if (_fd >= 0)
+  {
+    return true;
+  }
+  _fd = socket(AF_INET, SOCK_DGRAM, 0);
+  return _fd >= 0;
+}
+
+uint8_t WiFiUDP::begin(uint16_t port)
+{
+  stop();
+  if (!openSocket())
+  {
+    return 0;
+  }
+  sockaddr_in address = loopback(0);
+  address.sin_port = 0;
+  socklen_t address_len = sizeof(address);
+  if (bind(_fd, (sockaddr *)&address, sizeof(address)) != 0 ||
+      getsockname(_fd, (sockaddr *)&address, &address_len) != 0)
+  {
+    stop();
+    return 0;
+  }
+  HostNetwork::bindBoardPort(port, ntohs(address.sin_port));
+  return 1;
+}
+
+void WiFiUDP::stop()
+{
+  if (_fd >= 0)
+  {
+    close(_fd);
+    _fd = -1;
+  }
+  _tx_len = 0;
+  _rx_len = 0;
+  _rx_pos = 0;
+}
+
+int WiFiUDP::beginPacket(IPAddress ip, uint16_t port)
+{
+  (void)ip;
+  _dest_port = port;
+  _tx_len = 0;
+  return openSocket() ? 1 : 0;
+}
+
+int WiFiUDP::beginPacket(const char *host, uint16_t port)
+{
+  (void)host;
+  return beginPacket(IPAddress(), port);
+}
+
+size_t WiFiUDP::write(uint8_t c)
+{
+  return write(&c, 1);
+}
+
+size_t WiFiUDP::write(const uint8_t *buffer, size_t size)
+{
+  if (_tx_len + size > MAX_PACKET)
+  {
+    size = MAX_PACKET - _tx_len;
+  }
+  memcpy(_tx + _tx_len, buffer, size);
+  _tx_len += size;
+  return size;
+}
+
+int WiFiUDP::endPacket()
+{
+  if (_fd < 0)
+  {
+    return 0;
+  }
+  sockaddr_in address = loopback(_dest_port);
+  ssize_t n = sendto(_fd, _tx, _tx_len, 0, (sockaddr *)&address, sizeof(address));
+  _tx_len = 0;
+  return n >= 0 ? 1 : 0;
+}
+
+int WiFiUDP::parsePacket()
+{
+  if (_fd < 0)
+  {
+    return 0;
+  }
+  sockaddr_in address;
+  socklen_t address_len = sizeof(address);
+  ssize_t n = recvfrom(_fd, _rx, MAX_PACKET, MSG_DONTWAIT, (sockaddr *)&address, &address_len);
+  if (n <= 0)
+  {
+    _rx_len = 0;
+    _rx_pos = 0;
+    return 0;
+  }
+  _rx_len = n;
+  _rx_pos = 0;
+  _remote_ip = IPAddress(address.sin_addr.s_addr);
+  _remote_port = ntohs(address.sin_port);
+  return n;
+}
+
+int WiFiUDP::available()
+{
+  return _rx_len - _rx_pos;
+}
+
+int WiFiUDP::read()
+{
+  return _rx_pos < _rx_len ? _rx[_rx_pos++] : -1;
+}
+
+int WiFiUDP::read(uint8_t *buffer, size_t size)
+{
+  size_t left = _rx_len - _rx_pos;
+  if (size > left)
+  {
+    size = left;
+  }
+  memcpy(buffer, _rx + _rx_pos, size);
+  _rx_pos += size;
+  return size;
+}
+
+int WiFiUDP::peek()
+{
+  return _rx_pos < _rx_len ? _rx[_rx_pos] : -1;
+}
@@ -0,0 +1,98 @@
+/*
+WiFi.h - socket backed WiFi and WiFiClient for the host (Linux) build
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef HOST_WIFI_H
+#define HOST_WIFI_H
+
+#include <Arduino.h>
+#include <HostNetwork.h>
+
+typedef enum
+{
+  WL_IDLE_STATUS = 0,
+  WL_NO_SSID_AVAIL,
+  WL_SCAN_COMPLETED,
+  WL_CONNECTED,
+  WL_CONNECT_FAILED,
+  WL_CONNECTION_LOST,
+  WL_DISCONNECTED
+} wl_status_t;
+
+// The association always succeeds, the radio is the loopback interface. It
+// takes the time given to HostNetwork::setAssociationLatency(): the scan is
+// skipped by a join to the right BSSID and channel (ESP32 and ESP8266 API), a
+// static IP from config() skips DHCP, a join to another BSSID never completes
+class WiFiClass
+{
+public:
+  int begin(const char *ssid, const char *pwd);
+  int begin(const char *ssid, const char *pwd, int32_t channel, const uint8_t *bssid);
+  bool config(IPAddress local, IPAddress gateway, IPAddress subnet);
+  int disconnect();
+  uint8_t status();
+  uint8_t *BSSID(uint8_t *bssid);
+  int32_t channel();
+  uint8_t *macAddress(uint8_t *mac);
+  IPAddress localIP();
+  IPAddress gatewayIP();
+  IPAddress subnetMask();
+  int32_t RSSI();
+
+private:
+  uint8_t _status = WL_IDLE_STATUS;
+  uint32_t _joined_at = 0; // micros() of begin()
+  uint32_t _join_us = 0;   // how long the association takes
+  IPAddress _static_ip;    // 0.0.0.0: DHCP
+  IPAddress _gateway;
+  IPAddress _subnet;
+};
+
+extern WiFiClass WiFi;
+
+class WiFiClient : public Stream
+{
+public:
+  WiFiClient() {}
+  ~WiFiClient();
+  WiFiClient(const WiFiClient &) = delete;
+  WiFiClient &operator=(const WiFiClient &) = delete;
+
+  int connect(const char *host, uint16_t port);
+  int connect(IPAddress ip, uint16_t port);
+  // As on the ESP32: gives up when the handshake takes longer than timeout_ms
+  int connect(const char *host, uint16_t port, int32_t timeout_ms);
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t *buffer, size_t size) override;
+  using Print::write;
+  int available() override;
+  int read() override;
+  int read(uint8_t *buffer, size_t size);
+  int peek() override;
+  void flush() {}
+  void stop();
+  uint8_t connected();
+  operator bool() { return _fd >= 0; }
+
+private:
+  int _fd = -1;
+};
+
+#endif // HOST_WIFI_H
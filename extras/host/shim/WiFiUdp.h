@@ -0,0 +1,70 @@
+/*
+WiFiUdp.h - socket backed WiFiUDP for the host (Linux) build
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef HOST_WIFI_UDP_H
+#define HOST_WIFI_UDP_H
+
+#include <Arduino.h>
+#include <HostNetwork.h>
+
+class WiFiUDP : public Stream
+{
+public:
+  WiFiUDP() {}
+  ~WiFiUDP();
+  WiFiUDP(const WiFiUDP &) = delete;
+  WiFiUDP &operator=(const WiFiUDP &) = delete;
+
+  uint8_t begin(uint16_t port);
+  void stop();
+
+  int beginPacket(IPAddress ip, uint16_t port);
+  int beginPacket(const char *host, uint16_t port);
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t *buffer, size_t size) override;
+  using Print::write;
+  int endPacket();
+
+  int parsePacket();
+  int available() override;
+  int read() override;
+  int read(uint8_t *buffer, size_t size);
+  int peek() override;
+  IPAddress remoteIP() { return _remote_ip; }
+  uint16_t remotePort() { return _remote_port; }
+
+private:
+  static const uint16_t MAX_PACKET = 1500;
+
+  int _fd = -1;
+  uint16_t _dest_port = 0;
+  uint8_t _tx[MAX_PACKET];
+  uint16_t _tx_len = 0;
+  uint8_t _rx[MAX_PACKET];
+  uint16_t _rx_len = 0;
+  uint16_t _rx_pos = 0;
+  IPAddress _remote_ip;
+  uint16_t _remote_port = 0;
+
+  bool openSocket();
+};
+
+#endif // HOST_WIFI_UDP_H
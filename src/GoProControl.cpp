@@ -20,9 +20,18 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 */
 
 #include <GoProControl.h>
+#include <SettingsTable.h>
 #include <Utilities.h>
 
-// todo _request as char array
+// the paths of the commands stay in the flash of an AVR, makeRequest() copies
+// them into the request
+#if defined(__AVR__)
+#define GP_PATH(path) PSTR(path)
+#define GP_STRCAT(buff, flash) strcat_P(buff, flash)
+#else
+#define GP_PATH(path) (path)
+#define GP_STRCAT(buff, flash) strcat(buff, flash)
+#endif
 
 ////////////////////////////////////////////////////////////
 ////////                Constructor                 ////////
@@ -33,7 +42,11 @@ GoProControl::GoProControl(const char *ssid, const char *pwd, const uint8_t came
 {
   _ssid = (char *)ssid;
   _pwd = (char *)pwd;
+#if defined(GOPRO_CAMERA)
+  (void)camera;
+#else
   _camera = camera;
+#endif
 
   // GoPro MAC
   if (gopro_mac != NULL)
@@ -51,10 +64,15 @@ GoProControl::GoProControl(const char *ssid, const char *pwd, const uint8_t came
   {
     WiFi.setHostname(board_name);
   }
+#else
+  (void)board_name;
 #endif
-  _board_name = (char *)"";
-
   memset(_board_mac, 0, MAC_ADDRESS_LENGTH); // Empty the array
+
+  for (uint8_t i = 0; i < GOPRO_DEADLINE_SETS; i++)
+  {
+    _deadlines[i] = {CONNECT_DEADLINE, FIRST_BYTE_DEADLINE, BODY_DEADLINE};
+  }
 }
 
 ////////////////////////////////////////////////////////////
@@ -67,7 +85,7 @@ uint8_t GoProControl::begin()
   {
     if (_debug)
     {
-      _debug_port->println("Already connected");
+      _debug_port->println(F("Already connected"));
     }
     return false;
   }
@@ -76,50 +94,66 @@ uint8_t GoProControl::begin()
   {
     if (_debug)
     {
-      _debug_port->println("Camera not supported");
+      _debug_port->println(F("Camera not supported"));
     }
     return -1;
   }
 
   if (_debug)
   {
-    _debug_port->print("Attempting to connect to SSID: \"");
+    _debug_port->print(F("Attempting to connect to SSID: \""));
     _debug_port->print(_ssid);
-    _debug_port->print("\"\nUsing password: \"");
+    _debug_port->print(F("\"\nUsing password: \""));
     _debug_port->print(_pwd);
-    _debug_port->print("\"\n");
+    _debug_port->print(F("\"\n"));
   }
 
-  WiFi.begin(_ssid, _pwd);
+  startAssociation();
+  _expired = DEADLINE_NONE;
+  const bool outer = beginBlocking();
 
-  uint32_t start_time = millis();
-  while (WiFi.status() != WL_CONNECTED && start_time + MAX_WAIT_TIME > millis())
+  // the deadline holds for the directed join and the scan after it together
+  const uint32_t start_time = millis();
+  bool cancelled = false;
+  while (WiFi.status() != WL_CONNECTED && millis() - start_time < _associate_deadline &&
+         !(cancelled = takeCancel()))
   {
+    if (_boot.fast && millis() - start_time > FAST_CONNECT_WAIT)
+    {
+      fallbackAssociation();
+    }
     if (_debug)
     {
-      _debug_port->print(".");
+      _debug_port->print(F("."));
     }
-    delay(100);
+    delay(_boot.fast ? 10 : 100); // a directed join takes tens of milliseconds
+  }
+  if (outer)
+  {
+    _blocking = false;
   }
 
   if (WiFi.status() == WL_CONNECTED)
   {
     if (_debug)
     {
-      _debug_port->println("\nConnected to GoPro");
+      _debug_port->println(F("\nConnected to GoPro"));
     }
-    _connected = true;
-    getWiFiData();
+    finishAssociation();
     return true;
   }
   else
   {
     if (_debug)
     {
-      _debug_port->print("\nConnection failed with status: ");
+      _debug_port->print(F("\nConnection failed with status: "));
       _debug_port->println(WiFi.status());
     }
+    _expired = cancelled ? DEADLINE_CANCELLED : DEADLINE_ASSOCIATE;
+    metricAssociate();
     _connected = false;
+    _boot.full = micros() - _boot_phase;
+    _boot.total = micros() - _boot_start;
   }
 
   return -(WiFi.status());
@@ -131,21 +165,31 @@ void GoProControl::end()
   {
     if (_debug)
     {
-      _debug_port->println("Camera not connected yet");
+      _debug_port->println(F("Camera not connected yet"));
     }
     return;
   }
 
   if (_debug)
   {
-    _debug_port->println("Closing connection");
+    _debug_port->println(F("Closing connection"));
   }
   _udp_client.stop();
-  _wifi_client.stop();
+  _keep_alive_client.stop();
+  _keep_alive_open = false;
+  _wol_open = false;
+  closeClient();
   WiFi.disconnect();
   _connected = false;
   _recording = false;
+  _status_valid = false;
+  _status_stale = true;
   memset(_gopro_mac, 0, MAC_ADDRESS_LENGTH);
+
+  while (_async_count > 0)
+  {
+    completeAsync(0); // nobody is going to answer them
+  }
 }
 
 uint8_t GoProControl::keepAlive()
@@ -155,7 +199,8 @@ uint8_t GoProControl::keepAlive()
     return false;
   }
 
-  if (millis() - _last_request <= KEEP_ALIVE)
+  if (millis() - _last_keep_alive <= KEEP_ALIVE ||
+      (!_previewing && millis() - _last_request <= KEEP_ALIVE))
   {
     // we made a request not so much earlier
     return false;
@@ -172,9 +217,9 @@ uint8_t GoProControl::keepAlive()
     {
       if (_debug)
       {
-        _debug_port->println("Keeping connection alive");
+        _debug_port->println(F("Keeping connection alive"));
       }
-      sendRequest("_GPHD_:0:0:2:0.000000\n");
+      return sendKeepAlive();
     }
   }
   return true;
@@ -186,7 +231,7 @@ uint8_t GoProControl::confirmPairing()
   {
     if (_debug)
     {
-      _debug_port->println("Connect the camera first");
+      _debug_port->println(F("Connect the camera first"));
     }
     return false;
   }
@@ -195,7 +240,7 @@ uint8_t GoProControl::confirmPairing()
   {
     if (_debug)
     {
-      _debug_port->println("Not supported by HERO3");
+      _debug_port->println(F("Not supported by HERO3"));
     }
     return false;
   }
@@ -203,19 +248,105 @@ uint8_t GoProControl::confirmPairing()
   {
     if (_debug)
     {
-      _debug_port->println("Not implemented yet, see readME");
+      _debug_port->println(F("Not implemented yet, see readME"));
     }
     return false;
   }
   else if (_camera >= HERO5)
   {
-    makeRequest(_request, "/gp/gpControl/command/wireless/pair/complete?success=1&deviceName=",
+    makeRequest(_request, GP_PATH("/gp/gpControl/command/wireless/pair/complete?success=1&deviceName="),
                 _board_name);
   }
 
   return handleHTTPRequest(_request);
 }
 
+void GoProControl::setPersistentConnection(const bool enable)
+{
+  _persistent = enable;
+  if (_persistent == false)
+  {
+    flushAsync();
+    closeClient();
+  }
+}
+
+void GoProControl::setEarlyCompletion(const bool enable)
+{
+  _early = enable;
+}
+
+void GoProControl::setDeadlines(const GoProDeadlines &deadlines, const uint8_t command)
+{
+  if (command >= metric_commands)
+  {
+    for (uint8_t i = 0; i < GOPRO_DEADLINE_SETS; i++)
+    {
+      _deadlines[i] = deadlines;
+    }
+  }
+  else
+  {
+    _deadlines[deadlineSet(command)] = deadlines;
+  }
+}
+
+const GoProDeadlines &GoProControl::deadlines(const uint8_t command) const
+{
+  return _deadlines[deadlineSet(command)];
+}
+
+void GoProControl::setAssociateDeadline(const uint16_t ms)
+{
+  _associate_deadline = ms;
+}
+
+void GoProControl::cancel()
+{
+  _cancel = true; // acted on by poll() or by the loop which waits
+}
+
+uint8_t GoProControl::openConnection()
+{
+  if (_connected == false) // not connected
+  {
+    if (_debug)
+    {
+      _debug_port->println(F("Connect the camera first"));
+    }
+    return false;
+  }
+  if (_persistent == false)
+  {
+    if (_debug)
+    {
+      _debug_port->println(F("Enable the persistent connection first"));
+    }
+    return false;
+  }
+
+  flushAsync();
+  return connectClient();
+}
+
+void GoProControl::setFastConnect(const bool enable)
+{
+#if GOPRO_FAST_CONNECT
+  _fast_connect = enable;
+#else
+  if (enable && _debug)
+  {
+    _debug_port->println(F("Fast connect not supported by this board"));
+  }
+#endif
+}
+
+void GoProControl::forgetLink()
+{
+  _link_valid = false;
+  eraseLink();
+}
+
 ////////////////////////////////////////////////////////////
 ////////                    BLE                    /////////
 ////////////////////////////////////////////////////////////
@@ -230,7 +361,7 @@ uint8_t GoProControl::enableBLE()
   {
     if (_debug)
     {
-      _debug_port->println("Your camera doesn't have Bluetooth");
+      _debug_port->println(F("Your camera doesn't have Bluetooth"));
     }
     return false;
   }
@@ -244,7 +375,7 @@ uint8_t GoProControl::disableBLE()
   {
     if (_debug)
     {
-      _debug_port->println("Your camera doesn't have Bluetooth");
+      _debug_port->println(F("Your camera doesn't have Bluetooth"));
     }
     return false;
   }
@@ -258,7 +389,7 @@ uint8_t GoProControl::wifiOff()
   {
     if (_debug)
     {
-      _debug_port->println("Your camera doesn't have Bluetooth");
+      _debug_port->println(F("Your camera doesn't have Bluetooth"));
     }
     return false;
   }
@@ -268,7 +399,7 @@ uint8_t GoProControl::wifiOff()
   {
     if (_debug)
     {
-      _debug_port->println("First run enableBLE()");
+      _debug_port->println(F("First run enableBLE()"));
     }
     return false;
   }
@@ -283,7 +414,7 @@ uint8_t GoProControl::wifiOn()
   {
     if (_debug)
     {
-      _debug_port->println("Your camera doesn't have Bluetooth");
+      _debug_port->println(F("Your camera doesn't have Bluetooth"));
     }
     return false;
   }
@@ -302,14 +433,14 @@ uint8_t GoProControl::turnOn()
   {
     if (_debug)
     {
-      _debug_port->println("Connect the camera first");
+      _debug_port->println(F("Connect the camera first"));
     }
     return false;
   }
 
   if (_camera == HERO3)
   {
-    makeRequest(_request, "/bacpac/PW?t=", _pwd, "&p=%01");
+    makeRequest(_request, GP_PATH("/bacpac/PW?t="), _pwd, "&p=%01");
   }
   else if (_camera >= HERO4)
   {
@@ -317,45 +448,150 @@ uint8_t GoProControl::turnOn()
     {
       if (_debug)
       {
-        _debug_port->println("No BSSID, unable to turn on the camera");
+        _debug_port->println(F("No BSSID, unable to turn on the camera"));
 #if defined(ARDUINO_ARCH_ESP8266)
-        _debug_port->println("The ESP8266 can't get the BSSID, you need to pass it in the "
-                             "constructor, see the README");
+        _debug_port->println(F("The ESP8266 can't get the BSSID, you need to pass it in the "
+                               "constructor, see the README"));
 #endif
       }
       return false;
     }
+    else if (_defer)
+    {
+      // turnOnAsync(): the status request which follows waits for poll()
+      sendWoL(WOL_BURST);
+      return isOn();
+    }
     else
     {
-      sendWoL();
-      if (isOn())
-      {
-        return true;
-      }
-      else
-      {
-        return false;
-      }
+      uint32_t ready;
+      return powerOn(ready);
     }
   }
 
   return handleHTTPRequest(_request);
 }
 
+uint8_t GoProControl::powerOn(uint32_t &ready, const uint32_t deadline)
+{
+  ready = 0;
+  if (_connected == false) // not connected
+  {
+    if (_debug)
+    {
+      _debug_port->println(F("Connect the camera first"));
+    }
+    return false;
+  }
+
+  if (_camera == HERO3 || _gopro_mac[0] == 0)
+  {
+    // HERO3 can't tell when it is ready, see isOn()
+    const uint32_t start = millis();
+    const uint8_t result = turnOn();
+    ready = millis() - start;
+    return result;
+  }
+
+  flushAsync();
+  const bool outer = beginBlocking(); // a cancel() ends the probes too
+  const uint32_t start = millis();
+  // the probes are status requests with a short wait for the answer
+  GoProDeadlines probe = _deadlines[deadlineSet(METRIC_STATUS)];
+  if (probe.first_byte > POWER_ON_PROBE_WAIT)
+  {
+    probe.first_byte = POWER_ON_PROBE_WAIT;
+  }
+  if (probe.body > POWER_ON_PROBE_WAIT)
+  {
+    probe.body = POWER_ON_PROBE_WAIT;
+  }
+  sendWoL(WOL_BURST);
+
+  GoProStatus status;
+  bool answered = false;
+  bool woke = false;
+  bool cancelled = false;
+  uint32_t pause = POWER_ON_FIRST_PAUSE;
+  while (true)
+  {
+    if (fetchStatus(status, &probe) == true)
+    {
+      answered = true;
+      woke = !status.busy; // still booting or mounting the SD card
+    }
+    else if (WiFi.status() == WL_CONNECTED)
+    {
+      _connected = true; // the camera refused the connection, the WiFi is still there
+    }
+    cancelled = cancelled || _expired == DEADLINE_CANCELLED;
+
+    uint32_t elapsed = millis() - start;
+    if (woke || cancelled || elapsed >= deadline)
+    {
+      break;
+    }
+    if (!answered)
+    {
+      sendWoL(); // the burst may have been lost
+    }
+    // once up the busy flag clears soon, keep probing at the first pace
+    const uint32_t wait = elapsed + pause < deadline ? elapsed + pause : deadline;
+    while (elapsed < wait && !(cancelled = takeCancel()))
+    {
+      delay(1);
+      elapsed = millis() - start;
+    }
+    if (cancelled)
+    {
+      _expired = DEADLINE_CANCELLED;
+      break;
+    }
+    if (!answered)
+    {
+      pause = pause * 2 < POWER_ON_MAX_PAUSE ? pause * 2 : POWER_ON_MAX_PAUSE;
+    }
+  }
+  if (outer)
+  {
+    _blocking = false;
+  }
+
+  if (woke)
+  {
+    ready = millis() - start;
+  }
+  metricWake(ready, woke);
+  if (_debug)
+  {
+    if (woke)
+    {
+      _debug_port->print(F("Camera ready in "));
+      _debug_port->print(ready);
+      _debug_port->println(F(" ms"));
+    }
+    else
+    {
+      _debug_port->println(answered ? F("Camera still busy") : F("Camera didn't wake up"));
+    }
+  }
+  return woke;
+}
+
 uint8_t GoProControl::turnOff(const bool force)
 {
   if (_connected == false) // not connected
   {
     if (_debug)
     {
-      _debug_port->println("Connect the camera first");
+      _debug_port->println(F("Connect the camera first"));
     }
     return false;
   }
 
   if (_camera == HERO3)
   {
-    makeRequest(_request, "/bacpac/PW?t=", _pwd, "&p=%00");
+    makeRequest(_request, GP_PATH("/bacpac/PW?t="), _pwd, "&p=%00");
   }
   else if (_camera >= HERO4)
   {
@@ -364,7 +600,7 @@ uint8_t GoProControl::turnOff(const bool force)
       getBSSID();
       if (_debug)
       {
-        _debug_port->println("BSSID not ready, try again");
+        _debug_port->println(F("BSSID not ready, try again"));
       }
       return false;
     }
@@ -376,7 +612,7 @@ uint8_t GoProControl::turnOff(const bool force)
             "Forcing turnOff, you won't be able to turnOn again from arduino");
       }
     }
-    makeRequest(_request, "/gp/gpControl/command/system/sleep");
+    makeRequest(_request, GP_PATH("/gp/gpControl/command/system/sleep"));
   }
 
   return handleHTTPRequest(_request);
@@ -388,194 +624,535 @@ uint8_t GoProControl::turnOff(const bool force)
 
 char *GoProControl::getStatus()
 {
-  if (_connected == false) // not connected
+  return requestStatus() ? bodyString() : (char *)'\0';
+}
+
+uint16_t GoProControl::getStatus(char *buffer, const uint16_t len)
+{
+  // straight into the buffer while it arrives, the response buffer can be
+  // shorter than the answer
+  flushAsync();
+  BodyCopy copy = {buffer, len, 0, false};
+  _body_sink = copyBody;
+  _body_context = &copy;
+  return endCopy(requestStatus(), copy);
+}
+
+uint8_t GoProControl::getStatus(GoProStatus &status)
+{
+  uint16_t changed;
+  if (!refreshStatus(changed))
   {
-    if (_debug)
-    {
-      _debug_port->println("Connect the camera first");
-    }
-    return (char *)'\0';
+    return false;
   }
+  status = _status;
+  return true;
+}
 
-  if (_camera == HERO3)
+void GoProControl::setStatusCache(const uint32_t ttl)
+{
+  _status_ttl = ttl;
+}
+
+uint8_t GoProControl::refreshStatus(uint16_t &changed, const bool force)
+{
+  changed = 0;
+  if (!force && statusCached())
   {
-    makeRequest(_request, "/camera/sx?t=", _pwd);
-    sendHTTPRequest(_request);
-    if (listenResponse(true)) // set the parameter to true to add a delay waiting the response
-    {
-      int16_t len = extractResponselength();
-      char *status_buffer = (char *)malloc((len * sizeof(char))); // Allocate memory
-      int16_t start = stringSearch(_response_buffer, "\r\n\r\n") + 4;
-      int16_t end = start + len;
-      for(int i = 0; i < len; i++)
-      {
-        status_buffer[i] = _response_buffer[i + start];
-      }
-      if (len > 0)
-      {
-        return status_buffer;
-      }
-    }
+    return true;
   }
-  
-  else if (_camera >= HERO4)
+
+  GoProStatus status;
+  if (!fetchStatus(status))
   {
-    makeRequest(_request, "/gp/gpControl/status");
-    sendHTTPRequest(_request);
-    if (listenResponse(true)) // set the parameter to true to add a delay waiting the response
-    {
-      int16_t start = stringSearch(_response_buffer, "{\"s");
-      int16_t end = stringSearch(_response_buffer, "}}") + 2;
-      if (start != -1 && end != -1)
-      {
-        return stringCut(_response_buffer, start, end);
-      }
-    }
+    return false;
   }
-  return (char *)'\0';
+  changed = _status_valid ? statusChanges(_status, status) : (uint16_t)CHANGED_ALL;
+  _status = status;
+  _status_time = millis();
+  _status_valid = true;
+  _status_stale = false;
+
+  // someone may have pressed the buttons of the camera
+  _recording = status.recording;
+  if (status.settings[SETTING_MODE] != NO_CODE)
+  {
+    _mode = status.settings[SETTING_MODE];
+  }
+  return true;
 }
 
-char *GoProControl::getMediaList()
+bool GoProControl::requestStatus()
 {
   if (_connected == false) // not connected
   {
     if (_debug)
     {
-      _debug_port->println("Connect the camera first");
+      _debug_port->println(F("Connect the camera first"));
     }
-    return (char *)'\0';
+    return false;
   }
 
-  sendHTTPRequest("/gp/gpMediaList", 8080);
-  if (listenResponse(true))
+  if (_camera == HERO3)
   {
-    int16_t start = stringSearch(_response_buffer, "{\"i");
-    int16_t end = stringSearch(_response_buffer, "}]}]}") + 5; // 5 is the length of the pattern
-    if (start != -1 && end != -1)
-    {
-      return stringCut(_response_buffer, start, end);
-    }
+    makeRequest(_request, GP_PATH("/camera/sx?t="), _pwd); // a binary block
+  }
+  else
+  {
+    makeRequest(_request, GP_PATH("/gp/gpControl/status"));
   }
-  return (char *)'\0';
+  return requestResponse(_request);
 }
 
-bool GoProControl::isOn()
+bool GoProControl::requestMediaList()
 {
   if (_connected == false) // not connected
   {
     if (_debug)
     {
-      _debug_port->println("Connect the camera first");
+      _debug_port->println(F("Connect the camera first"));
     }
     return false;
   }
 
-  if (_camera == HERO3)
+  makeRequest(_request, GP_PATH("/gp/gpMediaList"));
+  return requestResponse(_request, 8080);
+}
+
+char *GoProControl::bodyString()
+{
+  if (_overflow || _body_len == 0)
   {
-    // this isn't supported by this camera so this function will always return
-    // true => with status on Hero3 we can see if camera is on with the Byte 0. if byte[0]=0 camera ON, if byte[0]=1 camera OFF
-    return true;
+    return nullptr;
   }
-  else if (_camera >= HERO4)
+  _response_buffer[_body_len] = '\0'; // storeBody() leaves room for it
+#if GOPRO_NO_HEAP
+  return _response_buffer;
+#else
+  // the caller frees it
+  char *body = (char *)malloc(_body_len + 1);
+  if (body != nullptr)
   {
-    makeRequest(_request, "/gp/gpControl/status");
+    memcpy(body, _response_buffer, _body_len + 1);
   }
+  return body;
+#endif
+}
 
-  if (sendHTTPRequest(_request) == true)
-  {
-    return true;
-  }
-  else
+void GoProControl::copyBody(void *context, const char *data, uint16_t len)
+{
+  BodyCopy *copy = (BodyCopy *)context;
+  const uint16_t room = copy->len > copy->used ? copy->len - copy->used - 1 : 0; // and the '\0'
+  if (len > room)
   {
-    return false;
+    copy->overflow = true;
+    len = room;
   }
+  memcpy(copy->buffer + copy->used, data, len);
+  copy->used += len;
 }
 
-bool GoProControl::isConnected(const bool silent)
+uint16_t GoProControl::endCopy(const bool answered, BodyCopy &copy)
 {
-  if (_connected == true)
+  _body_sink = nullptr;
+  _body_context = nullptr;
+  if (!answered || copy.used == 0)
   {
-    if (_debug && silent == false)
-    {
-      _debug_port->println("\nCamera connected");
-    }
-    return true;
+    return 0;
   }
-  else
+  if (copy.overflow)
   {
-    if (_debug && silent == false)
+    if (_debug)
     {
-      _debug_port->println("\nNot connected");
+      _debug_port->println(F("The buffer is too short for the answer"));
     }
-    return false;
+    return 0;
   }
+  copy.buffer[copy.used] = '\0';
+  return copy.used;
 }
 
-bool GoProControl::getConnection() // Add, test if gopro still connected without any action on camera. isConnected() need action on camera (shoot for example) to see if the camera is disconnected.
+uint8_t GoProControl::fetchStatus(GoProStatus &status, const GoProDeadlines *deadlines)
 {
-	
-  if (WiFi.status() == WL_CONNECTED)
+  if (_connected == false) // not connected
   {
     if (_debug)
     {
-      _debug_port->println("\nConnected to GoPro");
+      _debug_port->println(F("Connect the camera first"));
     }
-    _connected = true;
-    getWiFiData();
-    return true;
+    return false;
+  }
+
+  // decoded while it arrives, it never goes into _response_buffer
+  flushAsync();
+  StatusParser parser;     // JSON of HERO4 and newer
+  Hero3StatusParser block; // binary block of HERO3
+  uint8_t ids[setting_kinds];
+  if (_camera == HERO3)
+  {
+    block.reset(&status);
+    _body_sink = Hero3StatusParser::feed;
+    _body_context = &block;
+    makeRequest(_request, GP_PATH("/camera/sx?t="), _pwd);
   }
   else
   {
-    if (_debug)
+    // where the camera puts the settings we know in the "settings" object, 0
+    // leaves them out
+    const uint8_t generation =
+        _camera <= MAX ? settingByte(&camera_generation[_camera]) : (uint8_t)NO_GENERATION;
+    for (uint8_t kind = 0; kind < setting_kinds; kind++)
     {
-      _debug_port->print("\nConnection failed with status: ");
-      _debug_port->println(WiFi.status());
+      ids[kind] =
+          generation != NO_GENERATION ? settingByte(&settings_table[kind].id[generation]) : 0;
     }
-    _connected = false;
+    parser.reset(&status, ids);
+    _body_sink = JSONStream::feed;
+    _body_context = &parser;
+    makeRequest(_request, GP_PATH("/gp/gpControl/status"));
+  }
+  bool result = requestResponse(_request, 80, deadlines) && extractResponseCode() == 200;
+  _body_sink = nullptr;
+  _body_context = nullptr;
+  if (!result || !(_camera == HERO3 ? block.isComplete() : parser.isComplete()))
+  {
     return false;
   }
+
+  const uint8_t mode = _camera == HERO3 ? block.modeCode() : parser.modeCode();
+  const uint8_t sub_mode = _camera == HERO3 ? NO_CODE : parser.subModeCode();
+
+  // from the codes of the camera to the options of Settings.h
+  status.mode = settingOption(SETTING_MODE, mode);
+  if (sub_mode != NO_CODE)
+  {
+    status.sub_mode = settingOption(SETTING_MODE, SUB_MODE(mode, sub_mode));
+  }
+  for (uint8_t kind = 0; kind < setting_kinds; kind++)
+  {
+    if (kind != SETTING_MODE)
+    {
+      status.settings[kind] = settingOption(kind, status.settings[kind]);
+    }
+  }
+  status.settings[SETTING_MODE] = status.sub_mode != NO_CODE ? status.sub_mode : status.mode;
+  return true;
 }
 
-bool GoProControl::isRecording()
+bool GoProControl::statusCached()
+{
+  return _connected && _status_valid && !_status_stale && _status_ttl > 0 &&
+         millis() - _status_time < _status_ttl;
+}
+
+char *GoProControl::getMediaList()
+{
+  return requestMediaList() ? bodyString() : (char *)'\0';
+}
+
+uint16_t GoProControl::getMediaList(char *buffer, const uint16_t len)
+{
+  flushAsync();
+  BodyCopy copy = {buffer, len, 0, false};
+  _body_sink = copyBody;
+  _body_context = &copy;
+  return endCopy(requestMediaList(), copy);
+}
+
+uint8_t GoProControl::listMedia(GoProFileCallback on_file, void *context,
+                                const GoProMediaFilter *filter,
+                                GoProDirectoryCallback on_directory)
 {
   if (_connected == false) // not connected
   {
     if (_debug)
     {
-      _debug_port->println("Connect the camera first");
+      _debug_port->println(F("Connect the camera first"));
     }
     return false;
   }
 
-  return _recording;
-}
+  // the list is parsed while it arrives, it never goes into _response_buffer
+  flushAsync();
+  MediaListParser media;
+  media.reset(on_file, context, filter, on_directory);
+  _body_sink = JSONStream::feed;
+  _body_context = &media;
+  makeRequest(_request, GP_PATH("/gp/gpMediaList"));
+  bool result = requestResponse(_request, 8080) && extractResponseCode() == 200;
+  _body_sink = nullptr;
+  _body_context = nullptr;
 
-////////////////////////////////////////////////////////////
-////////                   Shoot                   /////////
-////////////////////////////////////////////////////////////
+  if (_debug)
+  {
+    _debug_port->print(F("Media files: "));
+    _debug_port->print(media.files());
+    _debug_port->print(F(", matching the filter: "));
+    _debug_port->println(media.matched());
+  }
+  return result && media.isComplete();
+}
 
-uint8_t GoProControl::shoot()
+uint8_t GoProControl::downloadMedia(const char *directory,
+                                    const char *file,
+                                    GoProDownloadSink sink,
+                                    void *context,
+                                    GoProDownload *download)
 {
   if (_connected == false) // not connected
   {
     if (_debug)
     {
-      _debug_port->println("Connect the camera first");
+      _debug_port->println(F("Connect the camera first"));
     }
     return false;
   }
 
-  bool result = false;
-
-  if (WIFI_MODE)
+  if (strlen(directory) + strlen(file) + 14 >= MAX_REQUEST_LEN)
   {
-    if (_camera == HERO3)
+    if (_debug)
     {
-      makeRequest(_request, "/bacpac/SH?t=", _pwd, "&p=%01");
+      _debug_port->println(F("Wrong parameter for downloadMedia"));
+    }
+    return -1;
+  }
+
+  GoProDownload progress = {0, 0, 0, 0, 0, 0};
+  if (download == nullptr)
+  {
+    download = &progress;
+  }
+
+  // the file goes to the sink while it arrives, a chunk at a time
+  flushAsync();
+  DownloadStream stream = {this, download, sink, context, download->received, 0, 0, false, false,
+                          false};
+  _body_sink = downloadBody;
+  _body_context = &stream;
+
+  const uint32_t start_time = millis();
+  const uint32_t first_byte = stream.offset;
+  bool complete = false;
+  const bool outer = beginBlocking(); // a cancel() ends the resumes too
+  for (uint8_t attempt = 0; attempt <= GOPRO_DOWNLOAD_RESUMES && !complete && !stream.failed &&
+                            _expired != DEADLINE_CANCELLED;
+       attempt++)
+  {
+    if (attempt > 0)
+    {
+      download->resumes++;
+      if (_debug)
+      {
+        _debug_port->print(F("Download interrupted, resuming from byte "));
+        _debug_port->println(stream.offset);
+      }
+    }
+
+    _range = stream.offset;
+    _range_end = download->until;
+    stream.started = false;
+    stream.reached = false;
+    // the chunks may have taken the place of the request
+    makeRequest(_request, GP_PATH("/videos/DCIM/"), directory, "/", file);
+    startRequest(_request);
+    if (!sendHTTPRequest(_request, 8080))
+    {
+      metricEnd();
+      break;
+    }
+    beginResponse();
+
+    // a big file takes long, give up only when nothing arrives for a while
+    uint32_t idle_time = millis();
+    uint32_t seen = 0;
+    while (!readResponse() && !stream.failed && !stream.reached)
+    {
+      if (_response_len != seen)
+      {
+        seen = _response_len;
+        idle_time = millis();
+      }
+      else if (responseExpired(idle_time))
+      {
+        break;
+      }
+      yield();
+    }
+    flushDownload(stream);
+    metricEnd();
+
+    const uint16_t code = _parser.headersDone() ? _parser.statusCode() : 0;
+    if (code != 0 && code != 200 && code != 206)
+    {
+      if (_debug)
+      {
+        _debug_port->print(F("Download failed with code "));
+        _debug_port->println(code);
+      }
+      stream.failed = true;
+    }
+    complete = (_parser.isComplete() || stream.reached) && !stream.failed;
+    if (!_persistent || !_parser.isComplete() || stream.failed || !_parser.keepAlive())
+    {
+      closeClient();
+    }
+  }
+  if (outer)
+  {
+    _blocking = false;
+  }
+  _range = 0;
+  _range_end = 0;
+  _body_sink = nullptr;
+  _body_context = nullptr;
+
+  download->received = stream.offset;
+  download->elapsed = millis() - start_time;
+  download->throughput = 0;
+  if (download->elapsed > 0)
+  {
+    download->throughput = (uint64_t)(stream.offset - first_byte) * 1000 / download->elapsed;
+  }
+  if (_debug)
+  {
+    _debug_port->print(F("Downloaded "));
+    _debug_port->print(download->received);
+    _debug_port->print(F(" bytes, "));
+    _debug_port->print(download->throughput);
+    _debug_port->println(F(" bytes/s"));
+  }
+  return complete;
+}
+
+bool GoProControl::isOn()
+{
+  if (_connected == false) // not connected
+  {
+    if (_debug)
+    {
+      _debug_port->println(F("Connect the camera first"));
+    }
+    return false;
+  }
+
+  if (statusCached())
+  {
+    return _status.powered;
+  }
+
+  if (_camera == HERO3)
+  {
+    // this isn't supported by this camera so this function will always return
+    // true => with status on Hero3 we can see if camera is on with the Byte 0. if byte[0]=0 camera ON, if byte[0]=1 camera OFF
+    return true;
+  }
+  else if (_camera >= HERO4)
+  {
+    makeRequest(_request, GP_PATH("/gp/gpControl/status"));
+  }
+
+  // any answer, even one too big for the buffer, means the camera is on
+  requestResponse(_request);
+  if (_response_len > 0)
+  {
+    return true;
+  }
+  else
+  {
+    return false;
+  }
+}
+
+bool GoProControl::isConnected(const bool silent)
+{
+  if (_connected == true)
+  {
+    if (_debug && silent == false)
+    {
+      _debug_port->println(F("\nCamera connected"));
+    }
+    return true;
+  }
+  else
+  {
+    if (_debug && silent == false)
+    {
+      _debug_port->println(F("\nNot connected"));
+    }
+    return false;
+  }
+}
+
+bool GoProControl::getConnection() // Add, test if gopro still connected without any action on camera. isConnected() need action on camera (shoot for example) to see if the camera is disconnected.
+{
+	
+  if (WiFi.status() == WL_CONNECTED)
+  {
+    if (_debug)
+    {
+      _debug_port->println(F("\nConnected to GoPro"));
+    }
+    _connected = true;
+    getWiFiData();
+    return true;
+  }
+  else
+  {
+    if (_debug)
+    {
+      _debug_port->print(F("\nConnection failed with status: "));
+      _debug_port->println(WiFi.status());
+    }
+    _connected = false;
+    return false;
+  }
+}
+
+bool GoProControl::isRecording()
+{
+  if (_connected == false) // not connected
+  {
+    if (_debug)
+    {
+      _debug_port->println(F("Connect the camera first"));
+    }
+    return false;
+  }
+
+  if (_status_ttl > 0) // ask the camera, the button may have been pressed
+  {
+    uint16_t changed;
+    refreshStatus(changed);
+  }
+  return _recording;
+}
+
+////////////////////////////////////////////////////////////
+////////                   Shoot                   /////////
+////////////////////////////////////////////////////////////
+
+uint8_t GoProControl::shoot()
+{
+  if (_connected == false) // not connected
+  {
+    if (_debug)
+    {
+      _debug_port->println(F("Connect the camera first"));
+    }
+    return false;
+  }
+
+  bool result = false;
+
+  if (WIFI_MODE)
+  {
+    if (_camera == HERO3)
+    {
+      makeRequest(_request, GP_PATH("/bacpac/SH?t="), _pwd, "&p=%01");
     }
     else if (_camera >= HERO4)
     {
-      makeRequest(_request, "/gp/gpControl/command/shutter?p=1");
+      makeRequest(_request, GP_PATH("/gp/gpControl/command/shutter?p=1"));
     }
 
     result = handleHTTPRequest(_request);
@@ -599,7 +1176,7 @@ uint8_t GoProControl::stopShoot()
   {
     if (_debug)
     {
-      _debug_port->println("Connect the camera first");
+      _debug_port->println(F("Connect the camera first"));
     }
     return false;
   }
@@ -610,11 +1187,11 @@ uint8_t GoProControl::stopShoot()
   {
     if (_camera == HERO3)
     {
-      makeRequest(_request, "/bacpac/SH?t=", _pwd, "&p=%00");
+      makeRequest(_request, GP_PATH("/bacpac/SH?t="), _pwd, "&p=%00");
     }
     else if (_camera >= HERO4)
     {
-      makeRequest(_request, "/gp/gpControl/command/shutter?p=0");
+      makeRequest(_request, GP_PATH("/gp/gpControl/command/shutter?p=0"));
     }
 
     result = handleHTTPRequest(_request);
@@ -638,208 +1215,109 @@ uint8_t GoProControl::stopShoot()
 
 uint8_t GoProControl::setMode(const uint8_t option)
 {
+  if (WIFI_MODE)
+  {
+    return applySetting(SETTING_MODE, option);
+  }
+
+  // BLE
   if (_connected == false) // not connected
   {
     if (_debug)
     {
-      _debug_port->println("Connect the camera first");
+      _debug_port->println(F("Connect the camera first"));
     }
     return false;
   }
 
   bool result = false;
-
-  if (WIFI_MODE)
-  {
-    if (_camera == HERO3)
-    {
-      switch (option)
-      {
-      case VIDEO_MODE:
-        _parameter = (char *)"00";
-        break;
-      case PHOTO_MODE:
-        _parameter = (char *)"01";
-        break;
-      case BURST_MODE:
-        _parameter = (char *)"02";
-        break;
-      case TIMELAPSE_MODE:
-        _parameter = (char *)"03";
-        break;
-      case TIMER_MODE:
-        _parameter = (char *)"04";
-        break;
-      case PLAY_HDMI_MODE:
-        _parameter = (char *)"05";
-        break;
-      default:
-        if (_debug)
-        {
-          _debug_port->println("Wrong parameter for setMode");
-        }
-        return -1;
-      }
-      makeRequest(_request, "camera/CM?t=", _pwd, "&p=%", _parameter);
-    }
-    else if (_camera >= HERO4)
-    {
-      _sub_parameter = (char *)"";
-      switch (option)
-      {
-      case VIDEO_MODE:
-        _parameter = (char *)"0";
-        break;
-      case VIDEO_SUB_MODE:
-        _parameter = (char *)"0";
-        _sub_parameter = (char *)"0";
-        break;
-      case VIDEO_TIMELAPSE_MODE:
-        _parameter = (char *)"0";
-        _sub_parameter = (char *)"1";
-        break;
-      case VIDEO_PHOTO_MODE:
-        _parameter = (char *)"0";
-        _sub_parameter = (char *)"2";
-        break;
-      case VIDEO_LOOPING_MODE:
-        _parameter = (char *)"0";
-        _sub_parameter = (char *)"3";
-        break;
-      case VIDEO_TIMEWARP_MODE:
-        _parameter = (char *)"0";
-        _sub_parameter = (char *)"4";
-        break;
-
-      case PHOTO_MODE:
-        _parameter = (char *)"1";
-        break;
-      case PHOTO_SINGLE_MODE:
-        _parameter = (char *)"1";
-        _sub_parameter = (char *)"1";
-        break;
-      case PHOTO_NIGHT_MODE:
-        _parameter = (char *)"1";
-        _sub_parameter = (char *)"2";
-        break;
-
-      case MULTISHOT_MODE:
-        _parameter = (char *)"2";
-        break;
-      case MULTISHOT_BURST_MODE:
-        _parameter = (char *)"2";
-        _sub_parameter = (char *)"0";
-        break;
-      case MULTISHOT_TIMELAPSE_MODE:
-        _parameter = (char *)"2";
-        _sub_parameter = (char *)"1";
-        break;
-      case MULTISHOT_NIGHTLAPSE_MODE:
-        _parameter = (char *)"2";
-        _sub_parameter = (char *)"2";
-        break;
-
-      default:
-        if (_debug)
-        {
-          _debug_port->println("Wrong parameter for setMode");
-        }
-        return -1;
-      }
-
-      if (_sub_parameter == (char *)"")
-      {
-        makeRequest(_request, "/gp/gpControl/command/mode?p=", _parameter);
-      }
-      else
-      {
-        makeRequest(_request, "/gp/gpControl/command/sub_mode?mode=", _parameter,
-                    "&sub_mode=", _sub_parameter);
-      }
-    }
-    _mode = option;
-    result = handleHTTPRequest(_request);
-  }
-  else
-  { // BLE
 #if defined(ARDUINO_ARCH_ESP32)
-    switch (option)
+  switch (option)
+  {
+  case VIDEO_MODE:
+    result = sendBLERequest(BLE_ModeVideo);
+    break;
+  case PHOTO_MODE:
+    result = sendBLERequest(BLE_ModePhoto);
+    break;
+  case MULTISHOT_MODE:
+    result = sendBLERequest(BLE_ModeMultiShot);
+    break;
+  default:
+    if (_debug)
     {
-    case VIDEO_MODE:
-      result = sendBLERequest(BLE_ModeVideo);
-      break;
-    case PHOTO_MODE:
-      result = sendBLERequest(BLE_ModePhoto);
-      break;
-    case MULTISHOT_MODE:
-      result = sendBLERequest(BLE_ModeMultiShot);
-      break;
-    default:
-      if (_debug)
-      {
-        _debug_port->println("Wrong parameter for setMode");
-      }
-      return -1;
+      _debug_port->println(F("Wrong parameter for setMode"));
     }
-#endif
+    return -1;
   }
+#endif
   return result;
 }
 
 uint8_t GoProControl::setOrientation(const uint8_t option)
 {
-  if (_connected == false) // not connected
+  return applySetting(SETTING_ORIENTATION, option);
+}
+
+uint8_t GoProControl::setSetting(const uint8_t option)
+{
+  // the enums of Settings.h don't overlap, the option tells which setting it is
+  for (uint8_t kind = 0; kind < setting_kinds; kind++)
   {
-    if (_debug)
+    const SettingTable table = readSettingTable(kind);
+    if (table.values == nullptr && option > table.first && option <= table.first + table.count)
     {
-      _debug_port->println("Connect the camera first");
+      return applySetting(kind, option);
     }
+  }
+
+  if (_debug)
+  {
+    _debug_port->println(F("Wrong parameter for setSetting"));
+  }
+  return -1;
+}
+
+uint8_t GoProControl::applyProfile(const GoProProfile &profile, int8_t &saved)
+{
+  saved = 0;
+  const bool cached = statusCached();
+  uint16_t changed;
+  if (!refreshStatus(changed))
+  {
     return false;
   }
 
-  if (_camera == HERO3)
+  int8_t wanted = 0;
+  int8_t sent = cached ? 0 : 1; // the status
+  for (uint8_t i = 0; i < setting_kinds; i++)
   {
-    switch (option)
+    const uint8_t kind = settingByte(&profile_order[i]);
+    const uint8_t option = profile.settings[kind];
+    if (option == NO_CODE)
     {
-    case ORIENTATION_UP:
-      _parameter = (char *)"00";
-      break;
-    case ORIENTATION_DOWN:
-      _parameter = (char *)"01";
-      break;
-    default:
-      if (_debug)
-      {
-        _debug_port->println("Wrong parameter for setOrientation");
-      }
-      return -1;
+      continue;
     }
-    makeRequest(_request, "camera/UP?t=", _pwd, "&p=%", _parameter);
-  }
-  else if (_camera >= HERO4)
-  {
-    switch (option)
+    wanted++;
+    // a mode is already set when the camera is in one of its sub modes, a
+    // setting the camera doesn't report (NO_CODE) is always sent
+    bool same = option == _status.settings[kind];
+    if (kind == SETTING_MODE)
     {
-    case ORIENTATION_UP:
-      _parameter = (char *)"0";
-      break;
-    case ORIENTATION_DOWN:
-      _parameter = (char *)"1";
-      break;
-    case ORIENTATION_AUTO:
-      _parameter = (char *)"2";
-      break;
-    default:
-      if (_debug)
+      same = option == _status.mode || option == _status.sub_mode;
+    }
+    if (!same)
+    {
+      sent++;
+      const uint8_t result = applySetting(kind, option);
+      if (result != true)
       {
-        _debug_port->println("Wrong parameter for setOrientation");
+        return result;
       }
-      return -1;
     }
-    makeRequest(_request, "/gp/gpControl/setting/52/", _parameter);
   }
-
-  return handleHTTPRequest(_request);
+  saved = wanted - sent;
+  return true;
 }
 
 ////////////////////////////////////////////////////////////
@@ -848,980 +1326,1832 @@ uint8_t GoProControl::setOrientation(const uint8_t option)
 
 uint8_t GoProControl::setVideoResolution(const uint8_t option)
 {
-  if (_connected == false) // not connected
-  {
-    if (_debug)
-    {
-      _debug_port->println("Connect the camera first");
-    }
-    return false;
-  }
+  return applySetting(SETTING_VIDEO_RESOLUTION, option);
+}
 
-  if (_camera == HERO3)
-  {
-    switch (option)
-    {
-    case VR_1080p:
-      _parameter = (char *)"06";
-      break;
-    case VR_960p:
-      _parameter = (char *)"05";
-      break;
-    case VR_720p:
-      _parameter = (char *)"03";
-      break;
-    case VR_WVGA:
-      _parameter = (char *)"01";
-      break;
-    default:
-      if (_debug)
-      {
-        _debug_port->println("Wrong parameter for setVideoResolution");
-      }
-      return -1;
-    }
-    makeRequest(_request, "camera/VR?t=", _pwd, "&p=%", _parameter);
+uint8_t GoProControl::setVideoFov(const uint8_t option)
+{
+  return applySetting(SETTING_VIDEO_FOV, option);
+}
+
+uint8_t GoProControl::setFrameRate(const uint8_t option)
+{
+  return applySetting(SETTING_FRAME_RATE, option);
+}
+
+uint8_t GoProControl::setVideoEncoding(const uint8_t option)
+{
+  return applySetting(SETTING_VIDEO_ENCODING, option);
+}
+
+////////////////////////////////////////////////////////////
+////////                   Photo                   /////////
+////////////////////////////////////////////////////////////
+
+uint8_t GoProControl::setPhotoResolution(const uint8_t option)
+{
+  return applySetting(SETTING_PHOTO_RESOLUTION, option);
+}
+
+uint8_t GoProControl::setTimeLapseInterval(float option)
+{
+  // 0.5 seconds is 0 in the table, 0 is accepted too
+  if (option == 0.5 || option == 0)
+  {
+    option = 0;
   }
-  else if (_camera >= HERO4)
+  else if (option < 1)
   {
-    switch (option)
-    {
-    case VR_5p6K:
-      _parameter = (char *)"21";
-      break;
-    case VR_4K:
-      _parameter = (char *)"1";
-      break;
-    case VR_2K:
-      _parameter = (char *)"4";
-      break;
-    case VR_2K_SuperView:
-      _parameter = (char *)"5";
-      break;
-    case VR_1440p:
-      _parameter = (char *)"7";
-      break;
-    case VR_1080p_SuperView:
-      _parameter = (char *)"8";
-      break;
-    case VR_1080p:
-      _parameter = (char *)"9";
-      break;
-    case VR_960p:
-      _parameter = (char *)"10";
-      break;
-    case VR_720p_SuperView:
-      _parameter = (char *)"11";
-      break;
-    case VR_720p:
-      _parameter = (char *)"12";
-      break;
-    case VR_WVGA:
-      _parameter = (char *)"13";
-      break;
-    default:
-      if (_debug)
-      {
-        _debug_port->println("Wrong parameter for setVideoResolution");
-      }
-      return -1;
-    }
-    makeRequest(_request, "/gp/gpControl/setting/2/", _parameter);
+    option = NO_CODE;
   }
+  return applySetting(SETTING_TIME_LAPSE, (uint8_t)option);
+}
 
-  return handleHTTPRequest(_request);
+uint8_t GoProControl::setContinuousShot(const uint8_t option)
+{
+  return applySetting(SETTING_CONTINUOUS_SHOT, option);
 }
 
-uint8_t GoProControl::setVideoFov(const uint8_t option)
+////////////////////////////////////////////////////////////
+////////                   Others                   ////////
+////////////////////////////////////////////////////////////
+
+uint8_t GoProControl::localizationOn()
 {
   if (_connected == false) // not connected
   {
     if (_debug)
     {
-      _debug_port->println("Connect the camera first");
+      _debug_port->println(F("Connect the camera first"));
     }
     return false;
   }
 
   if (_camera == HERO3)
   {
-    switch (option)
-    {
-    case WIDE_FOV:
-      _parameter = (char *)"00";
-      break;
-    case MEDIUM_FOV:
-      _parameter = (char *)"01";
-      break;
-    case NARROW_FOV:
-      _parameter = (char *)"02";
-      break;
-    default:
-      if (_debug)
-      {
-        _debug_port->println("Wrong parameter for setVideoFov");
-      }
-      return -1;
-    }
-
-    makeRequest(_request, "camera/FV?t=", _pwd, "&p=%", _parameter);
-  }
-  else if (_camera >= HERO4 && _camera <= HERO7)
-  {
-    switch (option)
-    {
-    case WIDE_FOV:
-      _parameter = (char *)"0";
-      break;
-    case MEDIUM_FOV:
-      _parameter = (char *)"1";
-      break;
-    case NARROW_FOV:
-      _parameter = (char *)"2";
-      break;
-    case LINEAR_FOV:
-      _parameter = (char *)"4";
-      break;
-    default:
-      if (_debug)
-      {
-        _debug_port->println("Wrong parameter for setVideoFov");
-      }
-      return -1;
-    }
-    makeRequest(_request, "/gp/gpControl/setting/4/", _parameter);
+    makeRequest(_request, GP_PATH("camera/LL?t="), _pwd, "&p=%01");
   }
-  else if (_camera >= HERO8)
+  else if (_camera >= HERO4)
   {
-    switch (option)
-    {
-    case DUAL360_FOV:
-      _parameter = (char *)"5";
-      break;
-    case WIDE_FOV:
-      _parameter = (char *)"0";
-      break;
-    case MEDIUM_FOV:
-      _parameter = (char *)"1";
-      break;
-    case NARROW_FOV:
-      _parameter = (char *)"6";
-      break;
-    case LINEAR_FOV:
-      _parameter = (char *)"4";
-      break;
-    default:
-      if (_debug)
-      {
-        _debug_port->println("Wrong parameter for setVideoFov");
-      }
-      return -1;
-    }
-    makeRequest(_request, "/gp/gpControl/setting/121/", _parameter);
+    makeRequest(_request, GP_PATH("/gp/gpControl/command/system/locate?p=1"));
   }
 
   return handleHTTPRequest(_request);
 }
 
-uint8_t GoProControl::setFrameRate(const uint8_t option)
+uint8_t GoProControl::localizationOff()
 {
   if (_connected == false) // not connected
   {
     if (_debug)
     {
-      _debug_port->println("Connect the camera first");
+      _debug_port->println(F("Connect the camera first"));
     }
     return false;
   }
 
   if (_camera == HERO3)
   {
-    switch (option)
-    {
-    case FR_240:
-      _parameter = (char *)"0a";
-      break;
-    case FR_120:
-      _parameter = (char *)"09";
-      break;
-    case FR_100:
-      _parameter = (char *)"08";
-      break;
-    case FR_60:
-      _parameter = (char *)"07";
-      break;
-    case FR_50:
-      _parameter = (char *)"06";
-      break;
-    case FR_48:
-      _parameter = (char *)"05";
-      break;
-    case FR_30:
-      _parameter = (char *)"04";
-      break;
-    case FR_25:
-      _parameter = (char *)"03";
-      break;
-    case FR_24:
-      _parameter = (char *)"02";
-      break;
-    case FR_12p5:
-      _parameter = (char *)"0b";
-      break;
-    case FR_15:
-      _parameter = (char *)"01";
-      break;
-    case FR_12:
-      _parameter = (char *)"00";
-      break;
-    default:
-      if (_debug)
-      {
-        _debug_port->println("Wrong parameter for setFrameRate");
-      }
-      return -1;
-    }
-    makeRequest(_request, "camera/FS?t=", _pwd, "&p=%", _parameter);
+    makeRequest(_request, GP_PATH("camera/LL?t="), _pwd, "&p=%00");
   }
   else if (_camera >= HERO4)
   {
-    switch (option)
-    {
-    case FR_240:
-      _parameter = (char *)"0";
-      break;
-    case FR_120:
-      _parameter = (char *)"1";
-      break;
-    case FR_100:
-      _parameter = (char *)"2";
-      break;
-    case FR_90:
-      _parameter = (char *)"3";
-      break;
-    case FR_80:
-      _parameter = (char *)"4";
-      break;
-    case FR_60:
-      _parameter = (char *)"5";
-      break;
-    case FR_50:
-      _parameter = (char *)"6";
-      break;
-    case FR_48:
-      _parameter = (char *)"7";
-      break;
-    case FR_30:
-      _parameter = (char *)"8";
-      break;
-    case FR_25:
-      _parameter = (char *)"9";
-      break;
-    default:
-      if (_debug)
-      {
-        _debug_port->println("Wrong parameter for setFrameRate");
-      }
-      return -1;
-    }
-    makeRequest(_request, "/gp/gpControl/setting/3/", _parameter);
+    makeRequest(_request, GP_PATH("/gp/gpControl/command/system/locate?p=0"));
   }
 
   return handleHTTPRequest(_request);
 }
 
-uint8_t GoProControl::setVideoEncoding(const uint8_t option)
+uint8_t GoProControl::deleteLast()
 {
   if (_connected == false) // not connected
   {
     if (_debug)
     {
-      _debug_port->println("Connect the camera first");
+      _debug_port->println(F("Connect the camera first"));
     }
     return false;
   }
 
   if (_camera == HERO3)
   {
-    switch (option)
-    {
-    case NTSC:
-      _parameter = (char *)"00";
-      break;
-    case PAL:
-      _parameter = (char *)"01";
-      break;
-    default:
-      if (_debug)
-      {
-        _debug_port->println("Wrong parameter for setVideoEncoding");
-      }
-      return -1;
-    }
-    makeRequest(_request, "camera/VM?t=", _pwd, "&p=%", _parameter);
+    makeRequest(_request, GP_PATH("camera/DL?t="), _pwd);
   }
   else if (_camera >= HERO4)
   {
-    switch (option)
-    {
-    case NTSC:
-      _parameter = (char *)"0";
-      break;
-    case PAL:
-      _parameter = (char *)"1";
-      break;
-    default:
-      if (_debug)
-      {
-        _debug_port->println("Wrong parameter for setVideoEncoding");
-      }
-      return -1;
-    }
-    makeRequest(_request, "/gp/gpControl/setting/57/", _parameter);
+    makeRequest(_request, GP_PATH("/gp/gpControl/command/storage/delete/last"));
   }
 
   return handleHTTPRequest(_request);
 }
 
-////////////////////////////////////////////////////////////
-////////                   Photo                   /////////
-////////////////////////////////////////////////////////////
-
-uint8_t GoProControl::setPhotoResolution(const uint8_t option)
+uint8_t GoProControl::deleteAll()
 {
   if (_connected == false) // not connected
   {
     if (_debug)
     {
-      _debug_port->println("Connect the camera first");
+      _debug_port->println(F("Connect the camera first"));
     }
     return false;
   }
 
   if (_camera == HERO3)
   {
-    switch (option)
-    {
-    case PR_11MP_WIDE:
-      _parameter = (char *)"00";
-      break;
-    case PR_8MP_WIDE:
-      _parameter = (char *)"01";
-      break;
-    case PR_5MP_WIDE:
-      _parameter = (char *)"02";
-      break;
-    default:
-      if (_debug)
-      {
-        _debug_port->println("Wrong parameter for setPhotoResolution");
-      }
-      return -1;
-    }
-    makeRequest(_request, "camera/PR?t=", _pwd, "&p=%", _parameter);
+    makeRequest(_request, GP_PATH("camera/DA?t="), _pwd);
   }
   else if (_camera >= HERO4)
   {
-    switch (option)
-    {
-    case PR_12MP_WIDE:
-      _parameter = (char *)"0";
-      break;
-    case PR_12MP_LINEAR:
-      _parameter = (char *)"10";
-      break;
-    case PR_12MP_MEDIUM:
-      _parameter = (char *)"8";
-      break;
-    case PR_12MP_NARROW:
-      _parameter = (char *)"9";
-      break;
-    case PR_7MP_WIDE:
-      _parameter = (char *)"1";
-      break;
-    case PR_7MP_MEDIUM:
-      _parameter = (char *)"2";
-      break;
-    case PR_5MP_WIDE:
-      _parameter = (char *)"3";
-      break;
-    default:
-      if (_debug)
-      {
-        _debug_port->println("Wrong parameter for setPhotoResolution");
-      }
-      return -1;
-    }
-    makeRequest(_request, "/gp/gpControl/setting/17/", _parameter);
+    makeRequest(_request, GP_PATH("/gp/gpControl/command/storage/delete/all"));
   }
 
   return handleHTTPRequest(_request);
 }
 
-uint8_t GoProControl::setTimeLapseInterval(float option)
+uint8_t GoProControl::startPreview()
 {
   if (_connected == false) // not connected
   {
     if (_debug)
     {
-      _debug_port->println("Connect the camera first");
+      _debug_port->println(F("Connect the camera first"));
     }
     return false;
   }
 
-  // convert float to integer
-  if (option == 0.5)
-  {
-    option = 0;
-  }
-  const uint8_t i_option = (uint8_t)option;
-
-  if (i_option != 0 && i_option != 1 && i_option != 5 && i_option != 10 && i_option != 30 &&
-      i_option != 60)
+  if (_camera == HERO3)
   {
     if (_debug)
     {
-      _debug_port->println("Wrong parameter for setTimeLapseInterval");
+      _debug_port->println(F("Not supported by HERO3"));
     }
-    return -1;
+    return false;
+  }
+  else if (_camera >= HERO4)
+  {
+    makeRequest(_request, GP_PATH("/gp/gpControl/execute?p1=gpStream&c1=restart"));
   }
 
-  if (_camera == HERO3)
+  return handleHTTPRequest(_request);
+}
+
+////////////////////////////////////////////////////////////
+////////                   Async                   /////////
+////////////////////////////////////////////////////////////
+
+void GoProControl::poll()
+{
+  if (takeCancel())
   {
-    switch (i_option)
-    {
-    case 60:
-      _parameter = (char *)"3c";
-      break;
-    case 30:
-      _parameter = (char *)"1e";
-      break;
-    case 10:
-      _parameter = (char *)"0a";
-      break;
-    case 5:
-      _parameter = (char *)"05";
-      break;
-    case 1:
-      _parameter = (char *)"01";
-      break;
-    case 0: // 0.5
-      _parameter = (char *)"00";
-      break;
-    default:
-      if (_debug)
-      {
-        _debug_port->println("Wrong parameter for setTimeLapseInterval");
-      }
-      return -1;
-    }
-    makeRequest(_request, "camera/TI?t=", _pwd, "&p=%", _parameter);
+    cancelAsync(); // raised by cancel(), maybe from another task
   }
-  else if (_camera >= HERO4)
+  // go through the steps that don't have to wait for the camera, stop at the
+  // first one that does. On a kept alive connection the rest of an answer
+  // which completed early comes before the next request
+  while (drainResponse() && _async_count > 0 && stepAsync())
   {
-    switch (i_option)
-    {
-    case 60:
-      _parameter = (char *)"6";
-      break;
-    case 30:
-      _parameter = (char *)"5";
-      break;
-    case 10:
-      _parameter = (char *)"4";
-      break;
-    case 5:
-      _parameter = (char *)"3";
-      break;
-    case 1:
-      _parameter = (char *)"1";
-      break;
-    case 0: // 0.5
-      _parameter = (char *)"0";
-      break;
-    default:
-      if (_debug)
-      {
-        _debug_port->println("Wrong parameter for setTimeLapseInterval");
-      }
-      return -1;
-    }
-    makeRequest(_request, "/gp/gpControl/setting/5/", _parameter);
   }
+  keepAlive(); // a datagram, only when nothing else went out for a while
+}
 
-  return handleHTTPRequest(_request);
+bool GoProControl::isBusy()
+{
+  return _async_count > 0 || _draining;
 }
 
-uint8_t GoProControl::setContinuousShot(const uint8_t option)
+uint8_t GoProControl::beginAsync(GoProCallback callback, void *context)
 {
-  if (_connected == false) // not connected
+  if (_connected == true)
   {
     if (_debug)
     {
-      _debug_port->println("Connect the camera first");
+      _debug_port->println(F("Already connected"));
     }
-    return false;
+    return 0;
   }
 
-  // convert float to integer
-  const uint8_t i_option = (uint8_t)option;
-
-  if (i_option != 0 || i_option != 3 || i_option != 5 || i_option != 10)
+  if (_camera <= HERO2)
   {
     if (_debug)
     {
-      _debug_port->println("Wrong parameter for setContinuousShot");
+      _debug_port->println(F("Camera not supported"));
     }
-    return -1;
+    return 0;
   }
 
-  if (_camera == HERO3)
+  if (!deferRequest(ASYNC_BEGIN, callback, context))
   {
-    switch (option)
-    {
-    case 10:
-      _parameter = (char *)"0a";
-      break;
-    case 5:
-      _parameter = (char *)"05";
-      break;
-    case 3:
-      _parameter = (char *)"03";
-      break;
-    case 0:
-      _parameter = (char *)"00";
-      break;
-    default:
-      if (_debug)
-      {
-        _debug_port->println("Wrong parameter for setContinuousShot");
-      }
-      return -1;
-    }
-    makeRequest(_request, "camera/CS?t=", _pwd, "&p=%", _parameter);
+    return 0;
   }
-  else if (_camera >= HERO4)
+
+  if (_debug)
   {
-    if (_debug)
-    {
-      _debug_port->println("Not supported by HERO4 and newer");
-    }
-    return false;
+    _debug_port->print(F("Attempting to connect to SSID: \""));
+    _debug_port->print(_ssid);
+    _debug_port->print(F("\"\n"));
   }
-  return handleHTTPRequest(_request);
+  startAssociation();
+  queueRequest("", 0);
+  return queuedRequest();
 }
 
-////////////////////////////////////////////////////////////
-////////                   Others                   ////////
-////////////////////////////////////////////////////////////
-
-uint8_t GoProControl::localizationOn()
+uint8_t GoProControl::turnOnAsync(GoProCallback callback, void *context)
 {
-  if (_connected == false) // not connected
+  // on HERO4 and newer the magic packet goes out now, the status request
+  // which follows it is the one that waits for poll()
+  if (!deferRequest(ASYNC_COMMAND, callback, context))
   {
-    if (_debug)
-    {
-      _debug_port->println("Connect the camera first");
-    }
-    return false;
+    return 0;
   }
+  turnOn();
+  return queuedRequest();
+}
 
-  if (_camera == HERO3)
+uint8_t GoProControl::turnOffAsync(GoProCallback callback, void *context, const bool force)
+{
+  if (!deferRequest(ASYNC_COMMAND, callback, context))
   {
-    makeRequest(_request, "camera/LL?t=", _pwd, "&p=%01");
+    return 0;
   }
-  else if (_camera >= HERO4)
+  turnOff(force);
+  return queuedRequest();
+}
+
+uint8_t GoProControl::getStatusAsync(GoProCallback callback, void *context)
+{
+  if (!deferRequest(ASYNC_COMMAND, callback, context))
   {
-    makeRequest(_request, "/gp/gpControl/command/system/locate?p=1");
+    return 0;
   }
-
-  return handleHTTPRequest(_request);
+  getStatus();
+  return queuedRequest();
 }
 
-uint8_t GoProControl::localizationOff()
+uint8_t GoProControl::getMediaListAsync(GoProCallback callback, void *context)
+{
+  if (!deferRequest(ASYNC_COMMAND, callback, context))
+  {
+    return 0;
+  }
+  getMediaList();
+  return queuedRequest();
+}
+
+uint8_t GoProControl::shootAsync(GoProCallback callback, void *context)
+{
+  if (!deferRequest(ASYNC_SHOOT, callback, context))
+  {
+    return 0;
+  }
+  shoot();
+  return queuedRequest();
+}
+
+uint8_t GoProControl::stopShootAsync(GoProCallback callback, void *context)
+{
+  if (!deferRequest(ASYNC_STOP_SHOOT, callback, context))
+  {
+    return 0;
+  }
+  stopShoot();
+  return queuedRequest();
+}
+
+uint8_t GoProControl::setModeAsync(const uint8_t option, GoProCallback callback, void *context)
+{
+  if (!deferRequest(ASYNC_COMMAND, callback, context))
+  {
+    return 0;
+  }
+  setMode(option);
+  return queuedRequest();
+}
+
+uint8_t GoProControl::setOrientationAsync(const uint8_t option, GoProCallback callback,
+                                          void *context)
+{
+  if (!deferRequest(ASYNC_COMMAND, callback, context))
+  {
+    return 0;
+  }
+  setOrientation(option);
+  return queuedRequest();
+}
+
+uint8_t GoProControl::setSettingAsync(const uint8_t option, GoProCallback callback,
+                                      void *context)
+{
+  if (!deferRequest(ASYNC_COMMAND, callback, context))
+  {
+    return 0;
+  }
+  setSetting(option);
+  return queuedRequest();
+}
+
+uint8_t GoProControl::setVideoResolutionAsync(const uint8_t option, GoProCallback callback,
+                                              void *context)
+{
+  if (!deferRequest(ASYNC_COMMAND, callback, context))
+  {
+    return 0;
+  }
+  setVideoResolution(option);
+  return queuedRequest();
+}
+
+uint8_t GoProControl::setVideoFovAsync(const uint8_t option, GoProCallback callback,
+                                       void *context)
+{
+  if (!deferRequest(ASYNC_COMMAND, callback, context))
+  {
+    return 0;
+  }
+  setVideoFov(option);
+  return queuedRequest();
+}
+
+uint8_t GoProControl::setFrameRateAsync(const uint8_t option, GoProCallback callback,
+                                        void *context)
+{
+  if (!deferRequest(ASYNC_COMMAND, callback, context))
+  {
+    return 0;
+  }
+  setFrameRate(option);
+  return queuedRequest();
+}
+
+uint8_t GoProControl::setVideoEncodingAsync(const uint8_t option, GoProCallback callback,
+                                            void *context)
+{
+  if (!deferRequest(ASYNC_COMMAND, callback, context))
+  {
+    return 0;
+  }
+  setVideoEncoding(option);
+  return queuedRequest();
+}
+
+uint8_t GoProControl::setPhotoResolutionAsync(const uint8_t option, GoProCallback callback,
+                                              void *context)
+{
+  if (!deferRequest(ASYNC_COMMAND, callback, context))
+  {
+    return 0;
+  }
+  setPhotoResolution(option);
+  return queuedRequest();
+}
+
+uint8_t GoProControl::setTimeLapseIntervalAsync(float option, GoProCallback callback,
+                                                void *context)
+{
+  if (!deferRequest(ASYNC_COMMAND, callback, context))
+  {
+    return 0;
+  }
+  setTimeLapseInterval(option);
+  return queuedRequest();
+}
+
+uint8_t GoProControl::setContinuousShotAsync(const uint8_t option, GoProCallback callback,
+                                             void *context)
+{
+  if (!deferRequest(ASYNC_COMMAND, callback, context))
+  {
+    return 0;
+  }
+  setContinuousShot(option);
+  return queuedRequest();
+}
+
+uint8_t GoProControl::localizationOnAsync(GoProCallback callback, void *context)
+{
+  if (!deferRequest(ASYNC_COMMAND, callback, context))
+  {
+    return 0;
+  }
+  localizationOn();
+  return queuedRequest();
+}
+
+uint8_t GoProControl::localizationOffAsync(GoProCallback callback, void *context)
+{
+  if (!deferRequest(ASYNC_COMMAND, callback, context))
+  {
+    return 0;
+  }
+  localizationOff();
+  return queuedRequest();
+}
+
+uint8_t GoProControl::deleteLastAsync(GoProCallback callback, void *context)
+{
+  if (!deferRequest(ASYNC_COMMAND, callback, context))
+  {
+    return 0;
+  }
+  deleteLast();
+  return queuedRequest();
+}
+
+uint8_t GoProControl::deleteAllAsync(GoProCallback callback, void *context)
+{
+  if (!deferRequest(ASYNC_COMMAND, callback, context))
+  {
+    return 0;
+  }
+  deleteAll();
+  return queuedRequest();
+}
+
+////////////////////////////////////////////////////////////
+////////                   Memory                  /////////
+////////////////////////////////////////////////////////////
+
+GoProFootprint GoProControl::footprint()
+{
+  GoProFootprint footprint;
+  footprint.total = sizeof(GoProControl);
+  footprint.response = sizeof(_response_buffer) + sizeof(_parser);
+#if GOPRO_LOW_RAM
+  footprint.request = 0; // in the response buffer
+#else
+  footprint.request = sizeof(_request);
+#endif
+#if GOPRO_ASYNC_SLOTS > 0
+  footprint.async = sizeof(_async);
+#else
+  footprint.async = 0;
+#endif
+  footprint.status = sizeof(_status);
+#if GOPRO_METRICS
+  footprint.metrics = sizeof(_metrics);
+#else
+  footprint.metrics = 0;
+#endif
+#if GOPRO_FAST_CONNECT
+  footprint.link = sizeof(_link) + sizeof(_boot);
+#else
+  footprint.link = sizeof(_boot);
+#endif
+  footprint.sockets = sizeof(_wifi_client) + sizeof(_udp_client) + sizeof(_keep_alive_client);
+  return footprint;
+}
+
+////////////////////////////////////////////////////////////
+////////                   Debug                   /////////
+////////////////////////////////////////////////////////////
+
+void GoProControl::enableDebug(UniversalSerial *debug_port, const uint32_t debug_baudrate)
+{
+  _debug = true;
+  _debug_port = debug_port;
+  _debug_port->begin(debug_baudrate);
+}
+
+void GoProControl::disableDebug()
+{
+  _debug_port->end();
+  _debug = false;
+}
+
+void GoProControl::printStatus()
+{
+  if (_debug)
+  {
+    _debug_port->print(F("\nSSID:\t\t"));
+    _debug_port->println(_ssid);
+    _debug_port->print(F("Password:\t"));
+    _debug_port->println(_pwd);
+    _debug_port->print(F("Camera:\t\t"));
+    if (_camera == 8)
+    {
+      _debug_port->println(F("FUSION"));
+    }
+    else if (_camera == 10)
+    {
+      _debug_port->println(F("MAX"));
+    }
+    else
+    {
+      _debug_port->print(F("HERO"));
+      if (_camera <= 7)
+      {
+        _debug_port->println(_camera);
+      }
+      else
+      {
+        _debug_port->println(_camera - 1);
+      }
+    }
+    _debug_port->print(F("Board Name:\t"));
+    _debug_port->println(_board_name);
+    _debug_port->print(F("IP Address:\t"));
+    _debug_port->println(WiFi.localIP());
+    _debug_port->print(F("RSSI:\t\t"));
+    _debug_port->print(WiFi.RSSI());
+    _debug_port->println(F(" dBm"));
+    _debug_port->print(F("Board MAC:\t"));
+    printArray(_board_mac, MAC_ADDRESS_LENGTH, ":", HEX, false, false, _debug_port);
+    _debug_port->print(F("GoPro MAC:\t"));
+    printArray(_gopro_mac, MAC_ADDRESS_LENGTH, ":", HEX, false, false, _debug_port);
+    _debug_port->println();
+  }
+}
+
+////////////////////////////////////////////////////////////
+////////                  Metrics                  /////////
+////////////////////////////////////////////////////////////
+
+#if GOPRO_METRICS
+void GoProControl::resetMetrics()
+{
+  memset(&_metrics, 0, sizeof(_metrics));
+}
+#endif
+
+void GoProControl::metricStart()
+{
+#if GOPRO_METRICS
+  _metric_command = _command;
+  _metric_start = micros();
+  _metric_connect = 0;
+  _metric_sent = 0;
+  _metric_send = 0;
+  _metric_first = 0;
+#endif
+}
+
+void GoProControl::metricConnected(const uint32_t start, const bool connected, const bool late)
+{
+#if GOPRO_METRICS
+  if (!connected)
+  {
+    _metrics.connect_failures++;
+  }
+  if (late && _metric_command < metric_commands)
+  {
+    _metrics.commands[_metric_command].late_connect++;
+  }
+  _metric_connect += micros() - start;
+#else
+  (void)start;
+  (void)connected;
+  (void)late;
+#endif
+}
+
+void GoProControl::metricSent(const uint32_t send)
+{
+#if GOPRO_METRICS
+  _metric_sent = micros();
+  _metric_send += send;
+  _metric_first = 0;
+#else
+  (void)send;
+#endif
+}
+
+void GoProControl::metricFirstByte()
+{
+#if GOPRO_METRICS
+  _metric_first = micros();
+#endif
+}
+
+void GoProControl::metricReconnect()
+{
+#if GOPRO_METRICS
+  _metrics.reconnects++;
+#endif
+}
+
+void GoProControl::metricWake(const uint32_t ready, const bool woke)
+{
+#if GOPRO_METRICS
+  if (woke)
+  {
+    _metrics.wake.add(ready * 1000);
+  }
+  else
+  {
+    _metrics.wake_failures++;
+  }
+#else
+  (void)ready;
+  (void)woke;
+#endif
+}
+
+void GoProControl::metricAssociate()
+{
+#if GOPRO_METRICS
+  if (_expired == DEADLINE_ASSOCIATE)
+  {
+    _metrics.late_associate++;
+  }
+#endif
+}
+
+void GoProControl::metricEnd()
+{
+#if GOPRO_METRICS
+  if (_metric_command == metric_commands)
+  {
+    return; // nothing was timed, as the association of beginAsync()
+  }
+  GoProCommandMetrics &command = _metrics.commands[_metric_command];
+  _metric_command = metric_commands;
+  if (_expired == DEADLINE_CANCELLED)
+  {
+    command.cancelled++;
+  }
+  if (_metric_sent == 0)
+  {
+    return; // the connection failed, counted by metricConnected()
+  }
+
+  command.requests++;
+  command.connect.add(_metric_connect);
+  command.send.add(_metric_send);
+  if (_metric_first != 0)
+  {
+    command.first_byte.add(_metric_first - _metric_sent);
+  }
+  command.total.add(micros() - _metric_start);
+
+  const uint16_t code = _parser.statusCode();
+  if (_expired == DEADLINE_FIRST_BYTE || _expired == DEADLINE_BODY)
+  {
+    _metrics.timeouts++;
+    if (_expired == DEADLINE_FIRST_BYTE)
+    {
+      command.late_first_byte++;
+    }
+    else
+    {
+      command.late_body++;
+    }
+  }
+  else if (code == 400)
+  {
+    _metrics.code_400++;
+  }
+  else if (code == 403)
+  {
+    _metrics.code_403++;
+  }
+  else if (code == 410)
+  {
+    _metrics.code_410++;
+  }
+  else if (code != 0 && (code < 200 || code > 299))
+  {
+    _metrics.code_other++;
+  }
+  if (_overflow)
+  {
+    _metrics.overflows++;
+  }
+#endif
+}
+
+////////////////////////////////////////////////////////////
+////////                  Private                  /////////
+////////////////////////////////////////////////////////////
+
+void GoProControl::sendWoL(const uint8_t packets)
+{
+  uint8_t preamble[] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+  IPAddress addr(255, 255, 255, 255);
+
+  _status_stale = true;
+  // open until end(), powerOn() sends many of them
+  if (!_wol_open)
+  {
+    _wol_open = _udp_client.begin(_udp_port);
+  }
+
+  for (uint8_t p = 0; p < packets; p++)
+  {
+    _udp_client.beginPacket(addr, _udp_port);
+    _udp_client.write(preamble, LEN(preamble));
+    for (uint8_t i = 0; i < 16; i++)
+    {
+      _udp_client.write(_gopro_mac, MAC_ADDRESS_LENGTH);
+    }
+    _udp_client.endPacket();
+  }
+}
+
+bool GoProControl::sendKeepAlive()
+{
+  static const char keep_alive[] = "_GPHD_:0:0:2:0.000000\n";
+
+  // a datagram on a socket of its own: the TCP connection of the commands is
+  // left alone
+  if (!_keep_alive_open)
+  {
+    _keep_alive_open = _keep_alive_client.begin(KEEP_ALIVE_PORT);
+    if (!_keep_alive_open)
+    {
+      return false;
+    }
+  }
+  _last_keep_alive = millis();
+  _keep_alive_client.beginPacket(_host, KEEP_ALIVE_PORT);
+  _keep_alive_client.write((const uint8_t *)keep_alive, sizeof(keep_alive) - 1);
+  return _keep_alive_client.endPacket() == 1;
+}
+
+bool GoProControl::handleHTTPRequest(const char *request)
+{
+  _status_stale = true; // the command may change what the camera reports
+  _code_only = _early;
+  const bool answered = requestResponse(request);
+  _code_only = false;
+  if (answered)
+  {
+    if (extractResponseCode() == 200)
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool GoProControl::requestResponse(const char *request, const uint16_t port,
+                                   const GoProDeadlines *deadlines)
+{
+  if (_defer)
+  {
+    queueRequest(request, port);
+    return false; // the answer goes to the callback
+  }
+  // the connection and the buffers are shared with the asynchronous commands
+  flushAsync();
+  startRequest(request, deadlines);
+  const bool outer = beginBlocking();
+
+  bool answered = false;
+  for (uint8_t attempt = 0; attempt < 2; attempt++)
+  {
+    if (!sendHTTPRequest(request, port))
+    {
+      break;
+    }
+    if (listenResponse())
+    {
+      answered = true;
+      break;
+    }
+    // a missed deadline isn't tried again, the wait is bounded
+    if (_reused == false || _response_len > 0 || _expired != DEADLINE_NONE)
+    {
+      break;
+    }
+    // the camera closed the keep-alive connection while it was idle: open a
+    // new one and send the request again
+    if (_debug)
+    {
+      _debug_port->println(F("Keep-alive connection dropped, reconnecting"));
+    }
+    metricReconnect();
+    closeClient();
+  }
+  if (outer)
+  {
+    _blocking = false;
+  }
+  metricEnd();
+  return answered;
+}
+
+bool GoProControl::sendHTTPRequest(const char *request, const uint16_t port)
+{
+  if (request[0] == '\0') // makeRequest() found it too long
+  {
+    return false;
+  }
+  if (!connectClient(port))
+  {
+    return false;
+  }
+  writeHTTPRequest(request, port);
+  return true;
+}
+
+void GoProControl::writeHTTPRequest(const char *request, const uint16_t port)
 {
-  if (_connected == false) // not connected
+  if (_debug)
+  {
+    _debug_port->print(F("HTTP request: "));
+    _debug_port->println(request);
+  }
+  // a single write: one AT+CIPSEND on an ESP01, one TCP segment with lwIP. It
+  // is stack, not counted by footprint(): 164 bytes with GOPRO_LOW_RAM
+  char head[MAX_REQUEST_LEN + HTTP_HEAD_LEN];
+  const uint16_t len = renderHTTPRequest(head, request, port);
+  const uint32_t start = micros();
+  _wifi_client.write((const uint8_t *)head, len);
+  _send_time = micros() - start;
+  _sent_at = millis(); // the answer deadlines start here
+  metricSent(_send_time);
+}
+
+// what follows the path when there is no Range, the same for every command of
+// a HERO4 and newer
+static const char http_tail_close[] PROGMEM =
+    " HTTP/1.1\r\nHost: " CAMERA_IP "\r\nConnection: close\r\n\r\n";
+static const char http_tail_keep_alive[] PROGMEM =
+    " HTTP/1.1\r\nHost: " CAMERA_IP "\r\nConnection: keep-alive\r\n\r\n";
+
+static char *appendDecimal(char *end, uint32_t number)
+{
+  char digits[10];
+  uint8_t count = 0;
+  do
+  {
+    digits[count++] = '0' + number % 10;
+    number /= 10;
+  } while (number > 0);
+  while (count > 0)
+  {
+    *end++ = digits[--count];
+  }
+  return end;
+}
+
+uint16_t GoProControl::renderHTTPRequest(char *buff, const char *request, const uint16_t port)
+{
+  char *end = buff;
+  memcpy(end, "GET ", 4);
+  end += 4;
+  const size_t path = strlen(request); // makeRequest() kept it under MAX_REQUEST_LEN
+  memcpy(end, request, path);
+  end += path;
+
+  if (_camera >= HERO4 && _range == 0 && _range_end == 0)
+  {
+    const char *tail = _persistent ? http_tail_keep_alive : http_tail_close;
+    const uint8_t tail_len = _persistent ? sizeof(http_tail_keep_alive) : sizeof(http_tail_close);
+#if defined(__AVR__)
+    memcpy_P(end, tail, tail_len);
+#else
+    memcpy(end, tail, tail_len);
+#endif
+    return end + tail_len - 1 - buff; // without the '\0'
+  }
+
+  strcpy(end, " HTTP/1.1\r\n");
+  end += strlen(end);
+  if (_camera == HERO3)
+  {
+    strcpy(end, "Host: " CAMERA_IP ":");
+    end = appendDecimal(end + strlen(end), port);
+    *end++ = '\r';
+    *end++ = '\n';
+  }
+  else if (_camera >= HERO4)
+  {
+    strcpy(end, "Host: " CAMERA_IP "\r\n");
+    end += strlen(end);
+  }
+  if (_range > 0 || _range_end > 0)
+  {
+    strcpy(end, "Range: bytes=");
+    end = appendDecimal(end + strlen(end), _range);
+    *end++ = '-';
+    if (_range_end > 0)
+    {
+      end = appendDecimal(end, _range_end - 1);
+    }
+    *end++ = '\r';
+    *end++ = '\n';
+  }
+  strcpy(end, _persistent ? "Connection: keep-alive\r\n\r\n" : "Connection: close\r\n\r\n");
+  end += strlen(end);
+  return end - buff;
+}
+
+#if defined(ARDUINO_ARCH_ESP32)
+uint8_t GoProControl::sendBLERequest(const uint8_t request[])
+{
+  if (_debug)
+  {
+    _debug_port->println(F("BLE request:"));
+    for (uint8_t i = 0; i <= 3; i++)
+    {
+      _debug_port->println(request[i]);
+    }
+  }
+  return true;
+}
+
+#endif
+
+uint8_t GoProControl::connectClient(const uint16_t port)
+{
+  // the rest of an answer which completed early: a keep-alive connection needs
+  // it out of the way, any other one is closed below
+  if (_draining && !_persistent)
+  {
+    closeClient();
+  }
+  while (!drainResponse())
+  {
+    yield();
+  }
+
+  const uint32_t start = micros();
+  if (_persistent && _client_port == port && _wifi_client.connected())
+  {
+    _reused = true;
+    _last_request = millis();
+    metricConnected(start, true, false);
+    return true;
+  }
+
+  if (_persistent && _client_port == port)
+  {
+    metricReconnect(); // the camera closed the keep-alive connection
+  }
+  closeClient();
+  _reused = false;
+
+  // a half asleep camera can hold the handshake for seconds, the other WiFi
+  // libraries can't be stopped and the late connections are only counted
+  const uint16_t limit = _deadline.connect;
+#if defined(ARDUINO_ARCH_ESP32) || defined(GOPRO_HOST)
+  const bool connected = _wifi_client.connect(_host, port, limit);
+#elif defined(ARDUINO_ARCH_ESP8266)
+  _wifi_client.setTimeout(limit); // used by connect() too
+  const bool connected = _wifi_client.connect(_host, port);
+#else
+  const bool connected = _wifi_client.connect(_host, port);
+#endif
+  const bool late = micros() - start >= (uint32_t)limit * 1000;
+  if (!connected)
   {
     if (_debug)
     {
-      _debug_port->println("Connect the camera first");
+      _debug_port->println(late ? F("Connection deadline missed") : F("Connection lost"));
+    }
+    if (late)
+    {
+      _expired = DEADLINE_CONNECT;
     }
+    _connected = false;
+    metricConnected(start, false, late);
     return false;
   }
+  else
+  {
+    if (_debug)
+    {
+      _debug_port->println(F("Client connected"));
+    }
+    _client_port = port;
+    _last_request = millis();
+    metricConnected(start, true, late);
+    return true;
+  }
+}
 
-  if (_camera == HERO3)
+void GoProControl::closeClient()
+{
+  _wifi_client.stop();
+  _client_port = 0;
+  _draining = false;
+}
+
+bool GoProControl::listenResponse()
+{
+  beginResponse();
+  while (!readResponse() && !answeredEarly() && !responseExpired(_sent_at))
   {
-    makeRequest(_request, "camera/LL?t=", _pwd, "&p=%00");
+    yield(); // let the WiFi stack run, ESP8266 would reset otherwise
   }
-  else if (_camera >= HERO4)
+  return endResponse();
+}
+
+void GoProControl::beginResponse()
+{
+  if (_code_only)
+  {
+    _parser.reset(); // nobody reads the body
+  }
+  else if (_body_sink != nullptr)
+  {
+    _parser.reset(_body_sink, _body_context);
+  }
+  else
+  {
+    _parser.reset(storeBody, this);
+  }
+  _body_len = 0;
+  _overflow = false;
+  _response_len = 0;
+#if !GOPRO_LOW_RAM
+  _response_buffer[0] = '\0'; // with GOPRO_LOW_RAM the request is still there
+#endif
+
+  if (_debug)
+  {
+    _debug_port->print(F("Waiting response"));
+  }
+}
+
+bool GoProControl::readResponse()
+{
+  // feed the parser with the bytes already arrived, it knows when the
+  // response is over
+  char chunk[GOPRO_LOW_RAM ? 32 : 64];
+  while (!_parser.isDone())
+  {
+    int available = _wifi_client.available();
+    if (available <= 0)
+    {
+      if (!_wifi_client.connected())
+      {
+        _parser.finish(); // closed by the camera
+      }
+      break;
+    }
+
+    if (available > (int)sizeof(chunk))
+    {
+      available = sizeof(chunk);
+    }
+    int len = _wifi_client.read((uint8_t *)chunk, available);
+    if (len <= 0)
+    {
+      break;
+    }
+    if (_response_len == 0)
+    {
+      metricFirstByte();
+    }
+    _response_len += len;
+    _parser.parse(chunk, len);
+  }
+  return _parser.isDone();
+}
+
+bool GoProControl::endResponse()
+{
+  if (_body_len > 0)
+  {
+    _response_buffer[_body_len] = '\0';
+  }
+
+  const bool early = answeredEarly() && !_parser.isDone();
+  if (early)
+  {
+    _draining = true; // read by poll() or before the next request
+    _drain_end = _sent_at + _deadline.body;
+  }
+  else if (!_persistent || !_parser.isComplete() || !_parser.keepAlive())
+  {
+    closeClient();
+  }
+
+  if (_debug)
+  {
+    if (early)
+    {
+      _debug_port->println(F("\nCompleted on the status line"));
+    }
+    else if (!_parser.isComplete())
+    {
+      _debug_port->println(F("\nResponse incomplete"));
+    }
+    if (_overflow)
+    {
+      _debug_port->print(F("\nbuffer not big enough to store data, body of "));
+      _debug_port->print(_parser.bodyLength());
+      _debug_port->println(F(" bytes"));
+    }
+    else
+    {
+      _debug_port->println(F("\nStart response body"));
+      _debug_port->println(_body_len > 0 ? _response_buffer : "");
+      _debug_port->println(F("\nEnd response body"));
+    }
+  }
+
+  return _parser.isComplete() || early;
+}
+
+bool GoProControl::answeredEarly()
+{
+  return _code_only && _parser.statusCode() != 0 && !_parser.isFailed();
+}
+
+bool GoProControl::drainResponse()
+{
+  if (!_draining)
+  {
+    return true;
+  }
+  // a connection which is closed anyway doesn't hold up the next request
+  const bool dropped = !_persistent && _async_count > 0;
+  if (!dropped && !readResponse() && (int32_t)(millis() - _drain_end) < 0)
+  {
+    return false; // more has to come
+  }
+  _draining = false;
+  if (!_persistent || !_parser.isComplete() || !_parser.keepAlive())
+  {
+    closeClient();
+  }
+  return true;
+}
+
+void GoProControl::startRequest(const char *request, const GoProDeadlines *deadlines)
+{
+  _command = metricCommand(request);
+  _deadline = deadlines != nullptr ? *deadlines : _deadlines[deadlineSet(_command)];
+  _expired = DEADLINE_NONE;
+  metricStart();
+}
+
+bool GoProControl::beginBlocking()
+{
+  // a cancel() raised before the call isn't for this one, the inner requests
+  // of powerOn() and downloadMedia() keep the one raised meanwhile
+  if (_blocking)
+  {
+    return false;
+  }
+  _cancel = false;
+  _blocking = true;
+  return true;
+}
+
+bool GoProControl::takeCancel()
+{
+  if (!_cancel)
+  {
+    return false;
+  }
+  _cancel = false;
+  return true;
+}
+
+void GoProControl::cancelAsync()
+{
+  if (_async_count > 0 && _async_state != ASYNC_IDLE)
+  {
+    if (_debug)
+    {
+      _debug_port->println(F("Request cancelled"));
+    }
+    closeClient();
+    _code_only = false;
+    _expired = DEADLINE_CANCELLED;
+    completeAsync(0);
+  }
+  else if (_draining)
+  {
+    closeClient(); // the rest of an answer which completed early
+  }
+}
+
+bool GoProControl::responseExpired(const uint32_t since)
+{
+  // since is the request written, or the last byte of a download
+  if (takeCancel())
+  {
+    _expired = DEADLINE_CANCELLED;
+  }
+  else if (_response_len == 0 && millis() - _sent_at > _deadline.first_byte)
+  {
+    _expired = DEADLINE_FIRST_BYTE;
+  }
+  else if (millis() - since > _deadline.body)
+  {
+    _expired = DEADLINE_BODY;
+  }
+  return _expired != DEADLINE_NONE;
+}
+
+uint8_t GoProControl::deadlineSet(const uint8_t command)
+{
+#if GOPRO_LOW_RAM
+  (void)command;
+  return 0;
+#else
+  return command < metric_commands ? command : (uint8_t)METRIC_OTHER;
+#endif
+}
+
+void GoProControl::storeBody(void *context, const char *data, uint16_t len)
+{
+  GoProControl *gp = (GoProControl *)context;
+  if (gp->_body_len + len > MAX_RESPONSE_LEN - 1)
+  {
+    gp->_overflow = true;
+    len = MAX_RESPONSE_LEN - 1 - gp->_body_len;
+  }
+  memcpy(&gp->_response_buffer[gp->_body_len], data, len);
+  gp->_body_len += len;
+}
+
+void GoProControl::downloadBody(void *context, const char *data, uint16_t len)
+{
+  DownloadStream *stream = (DownloadStream *)context;
+  GoProControl *gp = stream->gp;
+  if (!stream->started)
+  {
+    stream->started = true;
+    const uint16_t code = gp->_parser.statusCode();
+    if (code == 200)
+    {
+      stream->offset = 0; // the whole file, even if we asked for a Range
+    }
+    else if (code != 206)
+    {
+      stream->failed = true; // the body is an error page
+    }
+    if (gp->_parser.rangeTotal() > 0)
+    {
+      stream->download->size = gp->_parser.rangeTotal();
+    }
+    else if (gp->_parser.hasContentLength() && (code == 200 || stream->download->until == 0))
+    {
+      stream->download->size = stream->offset + gp->_parser.contentLength();
+    }
+  }
+
+  // a camera which ignores the Range sends more than we asked
+  const uint32_t until = stream->download->until;
+  if (until > 0)
+  {
+    const uint32_t position = stream->offset + stream->fill;
+    len = position >= until ? 0 : (until - position < len ? until - position : len);
+    stream->reached = position + len >= until;
+  }
+
+  while (len > 0 && !stream->failed)
+  {
+    char *chunk = gp->_response_buffer + stream->half * DOWNLOAD_CHUNK_LEN;
+    uint16_t run = DOWNLOAD_CHUNK_LEN - stream->fill;
+    if (run > len)
+    {
+      run = len;
+    }
+    memcpy(chunk + stream->fill, data, run);
+    stream->fill += run;
+    data += run;
+    len -= run;
+    if (stream->fill == DOWNLOAD_CHUNK_LEN)
+    {
+      gp->flushDownload(*stream);
+    }
+  }
+}
+
+void GoProControl::flushDownload(DownloadStream &stream)
+{
+  if (stream.fill == 0 || stream.failed)
+  {
+    return;
+  }
+  const uint8_t *chunk = (const uint8_t *)_response_buffer + stream.half * DOWNLOAD_CHUNK_LEN;
+  if (!stream.sink(stream.context, stream.offset, chunk, stream.fill))
+  {
+    if (_debug)
+    {
+      _debug_port->println(F("Download stopped by the sink"));
+    }
+    stream.failed = true;
+    return;
+  }
+  // the sink may still be writing this chunk, fill the other one
+  stream.offset += stream.fill;
+  stream.fill = 0;
+  stream.half ^= 1;
+}
+
+uint16_t GoProControl::extractResponseCode()
+{
+  if (_parser.statusCode() == 0) // the status line didn't arrive
+  {
+    return false;
+  }
+
+  uint16_t code = _parser.statusCode();
+
+  if (_debug)
   {
-    makeRequest(_request, "/gp/gpControl/command/system/locate?p=0");
+    _debug_port->print(F("Response code: "));
+    _debug_port->println(code);
+    if (code == 200)
+    {
+      _debug_port->println(F("Command: Accepted"));
+    }
+    else if (code == 400)
+    {
+      _debug_port->println(F("Command: Bad request"));
+    }
+    else if (code == 403)
+    {
+      _debug_port->println(F("Command: Wrong password"));
+    }
+    else if (code == 410)
+    {
+      _debug_port->println(F("Command: Failed"));
+    }
+    else
+    {
+      _debug_port->println(F("Command: Other error"));
+    }
   }
 
-  return handleHTTPRequest(_request);
+  return code;
 }
 
-uint8_t GoProControl::deleteLast()
+bool GoProControl::deferRequest(const uint8_t kind, GoProCallback callback, void *context)
 {
-  if (_connected == false) // not connected
+#if GOPRO_ASYNC_SLOTS > 0
+  if (_async_count == GOPRO_ASYNC_SLOTS)
   {
     if (_debug)
     {
-      _debug_port->println("Connect the camera first");
+      _debug_port->println(F("Too many asynchronous commands, call poll()"));
     }
     return false;
   }
 
-  if (_camera == HERO3)
-  {
-    makeRequest(_request, "camera/DL?t=", _pwd);
-  }
-  else if (_camera >= HERO4)
+  AsyncRequest &slot = _async[(_async_head + _async_count) % _async_ring];
+  slot.kind = kind;
+  slot.attempt = 0;
+  slot.callback = callback;
+  slot.context = context;
+  _defer = true;
+  _deferred = 0;
+  return true;
+#else
+  (void)kind;
+  (void)callback;
+  (void)context;
+  if (_debug)
   {
-    makeRequest(_request, "/gp/gpControl/command/storage/delete/last");
+    _debug_port->println(F("No asynchronous commands in this build"));
   }
-
-  return handleHTTPRequest(_request);
+  return false;
+#endif
 }
 
-uint8_t GoProControl::deleteAll()
+void GoProControl::queueRequest(const char *request, const uint16_t port)
 {
-  if (_connected == false) // not connected
+  // only the first request of a command is queued, turnOn() would send a second
+  // one only if the first one failed
+  _defer = false;
+#if GOPRO_ASYNC_SLOTS > 0
+  AsyncRequest &slot = _async[(_async_head + _async_count) % _async_ring];
+  // an empty request is one makeRequest() found too long, beginAsync() has none
+  if (request[0] == '\0' && slot.kind != ASYNC_BEGIN)
   {
-    if (_debug)
-    {
-      _debug_port->println("Connect the camera first");
-    }
-    return false;
+    return;
   }
 
-  if (_camera == HERO3)
+  strncpy(slot.request, request, MAX_REQUEST_LEN - 1);
+  slot.request[MAX_REQUEST_LEN - 1] = '\0';
+  slot.port = port;
+  slot.code_only = _code_only;
+  slot.start = micros();
+  if (++_async_handle == 0)
   {
-    makeRequest(_request, "camera/DA?t=", _pwd);
+    _async_handle = 1; // 0 means that nothing was queued
   }
-  else if (_camera >= HERO4)
-  {
-    makeRequest(_request, "/gp/gpControl/command/storage/delete/all");
-  }
-
-  return handleHTTPRequest(_request);
+  slot.handle = _async_handle;
+  _deferred = _async_handle;
+  _async_count++;
+#else
+  (void)request; // deferRequest() never let a command get here
+  (void)port;
+#endif
 }
 
-////////////////////////////////////////////////////////////
-////////                   Debug                   /////////
-////////////////////////////////////////////////////////////
-
-void GoProControl::enableDebug(UniversalSerial *debug_port, const uint32_t debug_baudrate)
+uint8_t GoProControl::queuedRequest()
 {
-  _debug = true;
-  _debug_port = debug_port;
-  _debug_port->begin(debug_baudrate);
+  // the command could have stopped before its request, for example on a wrong
+  // option: in that case nothing was queued
+  _defer = false;
+  uint8_t handle = _deferred;
+  _deferred = 0;
+  return handle;
 }
 
-void GoProControl::disableDebug()
+bool GoProControl::stepAsync()
 {
-  _debug_port->end();
-  _debug = false;
-}
+#if GOPRO_ASYNC_SLOTS > 0
+  AsyncRequest &slot = _async[_async_head];
 
-void GoProControl::printStatus()
-{
-  if (_debug)
+  switch (_async_state)
   {
-    _debug_port->print("\nSSID:\t\t");
-    _debug_port->println(_ssid);
-    _debug_port->print("Password:\t");
-    _debug_port->println(_pwd);
-    _debug_port->print("Camera:\t\t");
-    if (_camera == 8)
+  case ASYNC_IDLE:
+    _async_phase = millis();
+    _expired = DEADLINE_NONE;
+    _async_state = slot.kind == ASYNC_BEGIN ? ASYNC_ASSOCIATE : ASYNC_CONNECT;
+    return true;
+
+  case ASYNC_ASSOCIATE:
+    if (WiFi.status() == WL_CONNECTED)
     {
-      _debug_port->println("FUSION");
+      if (_debug)
+      {
+        _debug_port->println(F("\nConnected to GoPro"));
+      }
+      finishAssociation();
+      completeAsync(200);
+      return true;
     }
-    else if (_camera == 10)
+    if (_boot.fast && millis() - _async_phase > FAST_CONNECT_WAIT)
     {
-      _debug_port->println("MAX");
+      fallbackAssociation(); // the deadline still counts from the start
+      return false;
     }
-    else
+    if (millis() - _async_phase > _associate_deadline)
     {
-      _debug_port->print("HERO");
-      if (_camera <= 7)
+      if (_debug)
       {
-        _debug_port->println(_camera);
+        _debug_port->print(F("\nConnection failed with status: "));
+        _debug_port->println(WiFi.status());
       }
-      else
+      _expired = DEADLINE_ASSOCIATE;
+      metricAssociate();
+      completeAsync(0);
+      return true;
+    }
+    return false;
+
+  case ASYNC_CONNECT:
+    if (slot.attempt == 0)
+    {
+      startRequest(slot.request);
+    }
+    // the only step which blocks: WiFiClient has no non blocking connect, with
+    // setPersistentConnection(true) it happens only once
+    if (!connectClient(slot.port))
+    {
+      completeAsync(0);
+      return true;
+    }
+    _async_state = ASYNC_SEND;
+    return true;
+
+  case ASYNC_SEND:
+    writeHTTPRequest(slot.request, slot.port);
+    _code_only = slot.code_only;
+    beginResponse();
+    _async_state = ASYNC_RECEIVE;
+    return true;
+
+  case ASYNC_RECEIVE:
+    if (!readResponse() && !answeredEarly() && !responseExpired(_sent_at))
+    {
+      return false; // nothing more arrived, come back on the next poll()
+    }
+    endResponse();
+    _code_only = false;
+    if (!_parser.isComplete() && _reused && _response_len == 0 && slot.attempt == 0 &&
+        _expired == DEADLINE_NONE)
+    {
+      if (_debug)
       {
-        _debug_port->println(_camera - 1);
+        _debug_port->println(F("Keep-alive connection dropped, reconnecting"));
       }
+      metricReconnect();
+      closeClient();
+      slot.attempt++;
+      _async_state = ASYNC_CONNECT;
+      return true;
     }
-    _debug_port->print("Board Name:\t");
-    _debug_port->println(_board_name);
-    _debug_port->print("IP Address:\t");
-    _debug_port->println(WiFi.localIP());
-    _debug_port->print("RSSI:\t\t");
-    _debug_port->print(WiFi.RSSI());
-    _debug_port->println(" dBm");
-    _debug_port->print("Board MAC:\t");
-    printArray(_board_mac, MAC_ADDRESS_LENGTH, ":", HEX, false, false, _debug_port);
-    _debug_port->print("GoPro MAC:\t");
-    printArray(_gopro_mac, MAC_ADDRESS_LENGTH, ":", HEX, false, false, _debug_port);
-    _debug_port->println();
+    completeAsync(_parser.isComplete() || _draining ? extractResponseCode() : 0);
+    return true;
   }
+#endif
+  return false;
 }
 
-////////////////////////////////////////////////////////////
-////////                  Private                  /////////
-////////////////////////////////////////////////////////////
-
-void GoProControl::sendWoL()
+void GoProControl::completeAsync(const uint16_t code)
 {
-  uint8_t preamble[] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
-  IPAddress addr(255, 255, 255, 255);
+#if GOPRO_ASYNC_SLOTS > 0
+  AsyncRequest &slot = _async[_async_head];
+  _status_stale = true;
+  metricEnd();
 
-  _udp_client.begin(_udp_port);
-  _udp_client.beginPacket(addr, _udp_port);
-
-  _udp_client.write(preamble, LEN(preamble));
-
-  for (uint8_t i = 0; i < 16; i++)
+  GoProResult result;
+  result.handle = slot.handle;
+  result.code = code;
+  result.latency = micros() - slot.start;
+  result.body = _response_buffer;
+  result.body_len = 0;
+  result.expired = _expired;
+  if (code != 0 && slot.kind != ASYNC_BEGIN && _overflow == false)
   {
-    _udp_client.write(_gopro_mac, MAC_ADDRESS_LENGTH);
+    result.body_len = _body_len;
   }
-  _udp_client.endPacket();
-  _udp_client.stop();
-}
 
-uint8_t GoProControl::sendRequest(const char *request, bool silent)
-{
-  if (!connectClient())
+  if (code == 200 && slot.kind == ASYNC_SHOOT && _mode >= VIDEO_MODE &&
+      _mode <= VIDEO_TIMEWARP_MODE)
   {
-    return false;
+    _recording = true;
+  }
+  else if (code == 200 && slot.kind == ASYNC_STOP_SHOOT)
+  {
+    _recording = false;
   }
 
-  if (_debug && silent == false)
+  // free the slot before the callback, it may want to queue another command
+  GoProCallback callback = slot.callback;
+  void *context = slot.context;
+  _async_head = (_async_head + 1) % _async_ring;
+  _async_count--;
+  _async_state = ASYNC_IDLE;
+
+  if (callback != nullptr)
   {
-    _debug_port->print("Request: ");
-    _debug_port->println(request);
+    callback(context, result);
   }
-  _wifi_client.println(request);
-  _wifi_client.stop();
-  return true;
+#else
+  (void)code; // nothing is ever queued
+#endif
 }
 
-bool GoProControl::handleHTTPRequest(const char *request)
+void GoProControl::flushAsync()
 {
-  if (sendHTTPRequest(request))
+  while (_async_count > 0)
   {
-    listenResponse();
-    if (extractResponseCode() == 200)
-    {
-      return true;
-    }
+    poll();
+    yield();
   }
-  return false;
 }
 
-bool GoProControl::sendHTTPRequest(const char *request, const uint16_t port)
+uint8_t GoProControl::applySetting(const uint8_t kind, const uint8_t option)
 {
-  if (!connectClient(port))
+  if (_connected == false) // not connected
   {
+    if (_debug)
+    {
+      _debug_port->println(F("Connect the camera first"));
+    }
     return false;
   }
 
-  if (_debug)
+  const SettingTable table = readSettingTable(kind);
+  const uint8_t generation =
+      _camera <= MAX ? settingByte(&camera_generation[_camera]) : (uint8_t)NO_GENERATION;
+
+  uint8_t index = option - table.first - 1;
+  if (table.values != nullptr)
   {
-    _debug_port->print("HTTP request: ");
-    _debug_port->println(request);
+    index = 0;
+    while (index < table.count && settingByte(&table.values[index]) != option)
+    {
+      index++;
+    }
   }
-  _wifi_client.print("GET ");
-  _wifi_client.print(request);
-  _wifi_client.println(" HTTP/1.1");
-  if (_camera == HERO3)
+
+  uint8_t code = NO_CODE;
+  if (generation != NO_GENERATION && index < table.count && table.codes[generation] != nullptr)
   {
-    _wifi_client.print("Host: ");
-    _wifi_client.print(_host);
-    _wifi_client.print(":");
-    _wifi_client.println(port);
+    code = settingByte(&table.codes[generation][index]);
   }
-  else if (_camera >= HERO4)
+  if (code == NO_CODE)
   {
-    _wifi_client.print("Host: ");
-    _wifi_client.println(_host);
+    if (_debug)
+    {
+      _debug_port->println(F("Option not supported by this camera"));
+    }
+    return -1;
   }
-  _wifi_client.println("Connection: close");
-  _wifi_client.println();
-  return true;
-}
 
-#if defined(ARDUINO_ARCH_ESP32)
-uint8_t GoProControl::sendBLERequest(const uint8_t request[])
-{
-  if (_debug)
+  // extra is what is appended below, a request which doesn't fit is left
+  // empty and never sent
+  if (generation == GEN_HERO3)
   {
-    _debug_port->println("BLE request:");
-    for (uint8_t i = 0; i <= 3; i++)
+    // the two letters of the command and the literals stay in flash on AVR
+    const uint8_t extra = 2 + 3 + strlen(_pwd) + 6;
+    if (makeRequest(_request, GP_PATH("/camera/"), nullptr, nullptr, nullptr, extra))
     {
-      _debug_port->println(request[i]);
+      GP_STRCAT(_request, table.command);
+      GP_STRCAT(_request, GP_PATH("?t="));
+      strcat(_request, _pwd);
+      GP_STRCAT(_request, GP_PATH("&p=%"));
+      appendNumber(_request, code, true);
     }
   }
-  return true;
-}
-
-#endif
-
-uint8_t GoProControl::connectClient(const uint16_t port)
-{
-  if (!_wifi_client.connect(_host, port))
+  else if (kind == SETTING_MODE && code >> 4 == 0)
   {
-    if (_debug)
+    if (makeRequest(_request, GP_PATH("/gp/gpControl/command/mode?p="), nullptr, nullptr,
+                    nullptr, 3))
     {
-      _debug_port->println("Connection lost");
+      appendNumber(_request, code, false);
+    }
+  }
+  else if (kind == SETTING_MODE)
+  {
+    if (makeRequest(_request, GP_PATH("/gp/gpControl/command/sub_mode?mode="), nullptr, nullptr,
+                    nullptr, 16))
+    {
+      appendNumber(_request, code & 0x0F, false);
+      GP_STRCAT(_request, GP_PATH("&sub_mode="));
+      appendNumber(_request, (code >> 4) - 1, false);
     }
-    _connected = false;
-    return false;
   }
   else
   {
-    if (_debug)
+    if (makeRequest(_request, GP_PATH("/gp/gpControl/setting/"), nullptr, nullptr, nullptr, 7))
     {
-      _debug_port->println("Client connected");
+      appendNumber(_request, table.id[generation], false);
+      strcat(_request, "/");
+      appendNumber(_request, code, false);
     }
-    _last_request = millis();
-    return true;
   }
+
+  if (kind == SETTING_MODE)
+  {
+    _mode = option;
+  }
+  return handleHTTPRequest(_request);
 }
 
-bool GoProControl::listenResponse(const bool mediatimer)
+uint8_t GoProControl::settingOption(const uint8_t kind, const uint8_t code)
 {
-  uint16_t index = 0;
-
-  if (_debug)
+  const SettingTable table = readSettingTable(kind);
+  const uint8_t generation =
+      _camera <= MAX ? settingByte(&camera_generation[_camera]) : (uint8_t)NO_GENERATION;
+  if (code == NO_CODE || generation == NO_GENERATION || table.codes[generation] == nullptr)
   {
-    _debug_port->print("Waiting response");
+    return NO_CODE;
   }
-  uint32_t start_time = millis();
-  while ((_wifi_client.available() == 0) && (start_time + MAX_WAIT_TIME > millis()))
+
+  for (uint8_t index = 0; index < table.count; index++)
   {
-    if (_debug)
+    if (settingByte(&table.codes[generation][index]) == code)
     {
-      _debug_port->print(".");
-      delay(5);
+      return table.values != nullptr ? settingByte(&table.values[index])
+                                     : table.first + 1 + index;
     }
   }
+  return NO_CODE;
+}
 
-  if (mediatimer)
+void GoProControl::appendNumber(char *buff, const uint8_t number, const bool hex)
+{
+  const char digits[] = "0123456789abcdef";
+  char *end = buff + strlen(buff);
+  if (hex) // HERO3 wants always two digits
   {
-    delay(10); //Add delay. Without, response can be not complete for getmedia.
+    *end++ = digits[number >> 4];
+    *end++ = digits[number & 0x0F];
   }
-
-  if (_wifi_client.available() < MAX_RESPONSE_LEN) // Add verification to not overflow the buffer
+  else
   {
-    while (_wifi_client.available() > 0)
+    if (number >= 100)
     {
-      _response_buffer[index++] = _wifi_client.read();
+      *end++ = digits[number / 100];
     }
-    _response_buffer[index] = '\0';
-    _wifi_client.stop();
-
-    if (_debug)
+    if (number >= 10)
     {
-      _debug_port->println("\nStart response body");
-      _debug_port->println(_response_buffer);
-      _debug_port->println("\nEnd response body");
+      *end++ = digits[number / 10 % 10];
     }
+    *end++ = digits[number % 10];
   }
+  *end = '\0';
+}
 
-  else
+void GoProControl::startAssociation()
+{
+  memset(&_boot, 0, sizeof(_boot));
+  _boot_start = micros();
+#if GOPRO_FAST_CONNECT
+  if (_fast_connect)
   {
-    _response_buffer[index] = '\0';
-    if (_debug)
+    if (!_link_valid)
     {
-      _debug_port->println("buffer not big enough to store data");
+      _link_valid = loadLink(_link, _ssid);
     }
+    _boot.load = micros() - _boot_start;
   }
-  
-  if (strcmp(_response_buffer, "") == 0)
+  if (_fast_connect && _link_valid)
   {
-    return false;
+    if (_debug)
+    {
+      _debug_port->print(F("Joining the stored link on channel "));
+      _debug_port->println(_link.channel);
+    }
+    // no DHCP and no scan of the other channels
+    WiFi.config(IPAddress(_link.ip[0], _link.ip[1], _link.ip[2], _link.ip[3]),
+                IPAddress(_link.gateway[0], _link.gateway[1], _link.gateway[2], _link.gateway[3]),
+                IPAddress(_link.subnet[0], _link.subnet[1], _link.subnet[2], _link.subnet[3]));
+    const bool known = _link.bssid[0] | _link.bssid[1] | _link.bssid[2] | _link.bssid[3] |
+                       _link.bssid[4] | _link.bssid[5];
+    WiFi.begin(_ssid, _pwd, _link.channel, known ? _link.bssid : nullptr);
+    _boot.fast = true;
+    _boot_phase = micros();
+    return;
   }
-  else
+#endif
+  WiFi.begin(_ssid, _pwd);
+  _boot_phase = micros();
+}
+
+void GoProControl::fallbackAssociation()
+{
+  if (_debug)
   {
-    return true;
+    _debug_port->println(F("\nThe stored link didn't work, scanning"));
   }
+  _boot.directed = micros() - _boot_phase;
+  _boot.fast = false;
+  _link_valid = false;
+#if GOPRO_FAST_CONNECT
+  WiFi.disconnect();
+  WiFi.config(IPAddress(0, 0, 0, 0), IPAddress(0, 0, 0, 0), IPAddress(0, 0, 0, 0)); // DHCP
+#endif
+  WiFi.begin(_ssid, _pwd);
+  _boot_phase = micros();
 }
 
-uint16_t GoProControl::extractResponselength() // for getstatus(), look the length of the response
+void GoProControl::finishAssociation()
 {
-  if (strcmp(_response_buffer, "") == 0)
+  if (_boot.fast)
   {
-    return false;
+    _boot.directed = micros() - _boot_phase;
   }
-
-  int16_t start = stringSearch(_response_buffer, "Content-Length: ") + 16;
-  int16_t end = stringSearch(_response_buffer, "\r\n",start);
-  uint16_t code = atoi(stringCut(_response_buffer, start, end));
-
-  if (_debug)
+  else
   {
-    _debug_port->print("Response length: ");
-    _debug_port->print(code);
-    if (code == 0)
-    {
-      _debug_port->println("no data received");
-    }
-    else if (code > 0)
-    {
-      _debug_port->println(" bytes received");
-    }
+    _boot.full = micros() - _boot_phase;
   }
+  _connected = true;
+  getWiFiData();
 
-  return code;
+  if (_fast_connect && !_boot.fast)
+  {
+    const uint32_t start = micros();
+    storeLink();
+    _boot.save = micros() - start;
+  }
+  _boot.total = micros() - _boot_start;
 }
 
-uint16_t GoProControl::extractResponseCode()
+void GoProControl::storeLink()
 {
-  if (strcmp(_response_buffer, "") == 0)
+#if GOPRO_FAST_CONNECT
+  GoProLink link;
+  memset(&link, 0, sizeof(link));
+  link.magic = GOPRO_LINK_MAGIC;
+  link.ssid_hash = linkHash(_ssid);
+#if defined(ARDUINO_ARCH_ESP32) || defined(ARDUINO_ARCH_ESP8266)
+  const uint8_t *bssid = WiFi.BSSID();
+  if (bssid != nullptr)
   {
-    return false;
+    memcpy(link.bssid, bssid, sizeof(link.bssid));
   }
-
-  int8_t start = stringSearch(_response_buffer, " ") + 1;
-  int8_t end = stringSearch(_response_buffer, " ", start);
-  uint16_t code = atoi(stringCut(_response_buffer, start, end));
-
-  if (_debug)
+#else
+  WiFi.BSSID(link.bssid);
+#endif
+  link.channel = WiFi.channel();
+  const IPAddress ip = WiFi.localIP();
+  const IPAddress gateway = WiFi.gatewayIP();
+  const IPAddress subnet = WiFi.subnetMask();
+  for (uint8_t i = 0; i < 4; i++)
   {
-    _debug_port->print("Response code: ");
-    _debug_port->println(code);
-    if (code == 200)
-    {
-      _debug_port->println("Command: Accepted");
-    }
-    else if (code == 400)
-    {
-      _debug_port->println("Command: Bad request");
-    }
-    else if (code == 403)
-    {
-      _debug_port->println("Command: Wrong password");
-    }
-    else if (code == 410)
-    {
-      _debug_port->println("Command: Failed");
-    }
-    else
-    {
-      _debug_port->println("Command: Other error");
-    }
+    link.ip[i] = ip[i];
+    link.gateway[i] = gateway[i];
+    link.subnet[i] = subnet[i];
   }
 
-  return code;
+  // the flash wears out, write only what changed
+  if (_link_valid && memcmp(&link, &_link, sizeof(link)) == 0)
+  {
+    return;
+  }
+  _link = link;
+  _link_valid = link.channel != 0 && link.ip[0] != 0;
+  if (_link_valid && !saveLink(link) && _debug)
+  {
+    _debug_port->println(F("Unable to store the link"));
+  }
+#endif
 }
 
 void GoProControl::getBSSID()
 {
 #if defined(ARDUINO_ARCH_ESP32) || defined(ARDUINO_ARCH_ESP8266)
   // ESP32 and ESP8266 aren't compliant with the arduino API
-  _gopro_mac = WiFi.BSSID();
+  const uint8_t *bssid = WiFi.BSSID();
+  if (bssid != nullptr)
+  {
+    memcpy(_gopro_mac, bssid, MAC_ADDRESS_LENGTH);
+  }
 #else
   WiFi.BSSID(_gopro_mac);
 #endif
@@ -1847,7 +3177,7 @@ void GoProControl::getWiFiData()
   if (strcmp(_board_name, "") == 0)
   {
 #if defined(ARDUINO_ARCH_ESP32)
-    _board_name = (char *)WiFi.getHostname();
+    _board_name = WiFi.getHostname();
 #else
     // not supported by arduino api
 #endif
@@ -1865,10 +3195,32 @@ void GoProControl::revert(uint8_t mac[])
   }
 }
 
-void GoProControl::makeRequest(char *buff, const char *a, const char *b, const char *c,
-                               const char *d)
+bool GoProControl::makeRequest(char *buff, const char *a, const char *b, const char *c,
+                               const char *d, const uint8_t extra)
 {
+  // a is a GP_PATH(), the others are in RAM
+#if defined(__AVR__)
+  size_t len = strlen_P(a);
+#else
+  size_t len = strlen(a);
+#endif
+  len += (b != nullptr ? strlen(b) : 0) + (c != nullptr ? strlen(c) : 0) +
+         (d != nullptr ? strlen(d) : 0);
+  if (len + extra >= MAX_REQUEST_LEN)
+  {
+    if (_debug)
+    {
+      _debug_port->println(F("Request too long"));
+    }
+    buff[0] = '\0'; // never sent
+    return false;
+  }
+
+#if defined(__AVR__)
+  strcpy_P(buff, a);
+#else
   strcpy(buff, a);
+#endif
   if (b != nullptr)
   {
     strcat(buff, b);
@@ -1881,4 +3233,5 @@ void GoProControl::makeRequest(char *buff, const char *a, const char *b, const c
   {
     strcat(buff, d);
   }
+  return true;
 }
@@ -24,6 +24,14 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #include <Arduino.h>
 #include <Settings.h>
+#include <GoProLink.h>
+#include <GoProMetrics.h>
+#include <HTTPParser.h>
+#include <MediaListParser.h>
+#include <StatusParser.h>
+#if !defined(__AVR__)
+#include <atomic>
+#endif
 
 // include the correct wifi library
 #if defined(ARDUINO_ARCH_ESP32) // ESP32
@@ -45,6 +53,9 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #elif defined(ARDUINO_SAMD_MKRVIDOR4000) // MKR VIDOR 4000
 #include <VidorPeripherals.h>
 #include <WiFiNINA.h>
+#elif defined(GOPRO_HOST) // Linux host build, see extras/host
+#include <WiFi.h>
+#define INVERT_MAC
 #else // any board (like arduino UNO) without wifi + ESP01 with AT commands
 #include <WiFiEsp.h>
 #define AT_COMMAND
@@ -70,8 +81,162 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #define UniversalSerial HardwareSerial
 #endif
 
+// low RAM profile for the 2 kB of an ATmega328: the request and the answer
+// share a window of 64 bytes, the answers are parsed while they arrive and
+// there are no asynchronous commands, see footprint() and the README
+#if !defined(GOPRO_LOW_RAM)
+#define GOPRO_LOW_RAM 0
+#endif
+
 #define MAC_ADDRESS_LENGTH 6
+#if GOPRO_LOW_RAM
+#define MAX_RESPONSE_LEN 64
+#define MAX_REQUEST_LEN 64
+#else
 #define MAX_RESPONSE_LEN 1500
+#define MAX_REQUEST_LEN 100
+#endif
+#define HTTP_HEAD_LEN 100 // the request line and the headers without the path
+#define CAMERA_IP "10.5.5.9"
+#define KEEP_ALIVE_PORT 8554 // UDP, the live preview is streamed to the same port
+
+// power on of HERO4 and newer: a burst of magic packets, then the status is
+// asked after a pause which doubles until the camera answers and isn't busy
+#if !defined(WOL_BURST)
+#define WOL_BURST 3
+#endif
+#if !defined(POWER_ON_DEADLINE)
+#define POWER_ON_DEADLINE 10000
+#endif
+#define POWER_ON_FIRST_PAUSE 50
+#define POWER_ON_MAX_PAUSE 200 // bounds how long a ready camera goes unseen
+#define POWER_ON_PROBE_WAIT 300 // a sleeping camera takes the connection but never answers
+
+// deadlines of the phases of a request in milliseconds, see setDeadlines()
+#if !defined(ASSOCIATE_DEADLINE)
+#define ASSOCIATE_DEADLINE MAX_WAIT_TIME
+#endif
+#if !defined(CONNECT_DEADLINE)
+#define CONNECT_DEADLINE MAX_WAIT_TIME
+#endif
+#if !defined(FIRST_BYTE_DEADLINE)
+#define FIRST_BYTE_DEADLINE MAX_WAIT_TIME
+#endif
+#if !defined(BODY_DEADLINE)
+#define BODY_DEADLINE MAX_WAIT_TIME
+#endif
+// with GOPRO_LOW_RAM every kind of command shares the same deadlines
+#if GOPRO_LOW_RAM
+#define GOPRO_DEADLINE_SETS 1
+#else
+#define GOPRO_DEADLINE_SETS metric_commands
+#endif
+
+// how many asynchronous commands can wait for poll(), each one keeps a copy of
+// its request
+#if !defined(GOPRO_ASYNC_SLOTS)
+#if GOPRO_LOW_RAM
+#define GOPRO_ASYNC_SLOTS 0
+#elif defined(ARDUINO_ARCH_AVR)
+#define GOPRO_ASYNC_SLOTS 1
+#else
+#define GOPRO_ASYNC_SLOTS 4
+#endif
+#endif
+
+// getStatus() and getMediaList() return the response buffer, valid until the
+// next command, instead of a copy for the caller to free: with it nothing is
+// taken from the heap after the constructor
+#if !defined(GOPRO_NO_HEAP)
+#define GOPRO_NO_HEAP 0
+#endif
+
+// Bytes of a GoProControl, where they go, see footprint(). Sending a request
+// also takes MAX_REQUEST_LEN + HTTP_HEAD_LEN bytes of stack for a moment
+struct GoProFootprint
+{
+  uint32_t total; // sizeof(GoProControl), nothing else is allocated
+  uint32_t response; // MAX_RESPONSE_LEN
+  uint32_t request;  // MAX_REQUEST_LEN, 0 with GOPRO_LOW_RAM
+  uint32_t async;    // GOPRO_ASYNC_SLOTS
+  uint32_t status;   // the status cache
+  uint32_t metrics;  // GOPRO_METRICS
+  uint32_t link;     // fast connect
+  uint32_t sockets;  // the client and the two UDP sockets of the WiFi library
+};
+
+// Milliseconds every phase of a request may take, counted from its start: the
+// connection from the call, the first byte and the end of the answer from the
+// request written. Downloads give up only when nothing arrives for body
+struct GoProDeadlines
+{
+  uint16_t connect;
+  uint16_t first_byte;
+  uint16_t body;
+};
+
+// What stopped a request before the end of its answer
+enum gopro_deadline : uint8_t
+{
+  DEADLINE_NONE,
+  DEADLINE_ASSOCIATE,
+  DEADLINE_CONNECT,
+  DEADLINE_FIRST_BYTE,
+  DEADLINE_BODY,
+  DEADLINE_CANCELLED
+};
+
+// What an asynchronous command gives to its callback
+struct GoProResult
+{
+  uint8_t handle;    // the one returned by the *Async() function
+  uint16_t code;     // HTTP status code, 0 if the camera didn't answer
+  uint32_t latency;  // microseconds from the *Async() call to the answer
+  const char *body;  // body of the answer, valid only inside the callback
+  uint16_t body_len; // 0 if there is no body or it didn't fit the buffer
+  uint8_t expired;   // gopro_deadline, DEADLINE_NONE if nothing stopped it
+};
+
+typedef void (*GoProCallback)(void *context, const GoProResult &result);
+
+// What downloadMedia() gives to the sink at a time, two chunks are kept in the
+// response buffer
+#if GOPRO_LOW_RAM
+#define DOWNLOAD_CHUNK_LEN 32
+#else
+#define DOWNLOAD_CHUNK_LEN 512
+#endif
+#if !defined(GOPRO_DOWNLOAD_RESUMES)
+#define GOPRO_DOWNLOAD_RESUMES 3 // times a dropped download goes on with a Range request
+#endif
+
+// Called with every chunk of the file, offset is where data goes in the file.
+// data isn't touched until the following call, so the sink can start an
+// asynchronous write (SD card, socket) and return at once. Return false to
+// stop the download
+typedef bool (*GoProDownloadSink)(void *context, uint32_t offset, const uint8_t *data,
+                                  uint16_t len);
+
+// Progress of downloadMedia(), give the same struct again to go on with a
+// download which didn't complete
+struct GoProDownload
+{
+  uint32_t received;   // bytes given to the sink
+  uint32_t until;      // stop before this byte, 0 for the whole file
+  uint32_t size;       // of the file, 0 if the camera didn't tell
+  uint8_t resumes;     // times the connection dropped and the download went on
+  uint32_t elapsed;    // milliseconds of the last downloadMedia()
+  uint32_t throughput; // bytes per second of the last downloadMedia()
+};
+
+// Wanted option of every setting_kind, as in GoProStatus.settings: VR_1080p,
+// FR_60, 5 seconds of time-lapse, ... NO_CODE leaves the setting as it is
+struct GoProProfile
+{
+  uint8_t settings[setting_kinds];
+
+  GoProProfile() { memset(settings, NO_CODE, sizeof(settings)); }
+};
 
 class GoProControl
 {
@@ -88,6 +253,36 @@ public:
   void end();
   uint8_t keepAlive();
   uint8_t confirmPairing();
+  void setPersistentConnection(const bool enable);
+  // Open the keep-alive connection now so that the next command doesn't wait
+  // for the handshake, needs setPersistentConnection(true)
+  uint8_t openConnection();
+  // The commands which only need the code of the answer (shutter, mode,
+  // settings, delete, ...) return as soon as the status line arrives, the rest
+  // of the answer is read by poll() or before the next request
+  void setEarlyCompletion(const bool enable);
+  // Keep the BSSID, channel and IP given by the camera network in flash (a
+  // file on the host build): the next begin() joins without a scan and without
+  // DHCP, and goes back to a full association if that fails
+  void setFastConnect(const bool enable);
+  void forgetLink();
+  const GoProBootTiming &bootTiming() const { return _boot; }
+  // Deadlines of the requests of a kind of command (METRIC_SHUTTER,
+  // METRIC_STATUS, ... see GoProMetrics.h), metric_commands sets every kind. A
+  // request which misses one fails with the phase in expired(). A command
+  // queued behind another one waits at most the connect and body deadlines of
+  // the one in front, ESP32, ESP8266 and the host build can stop a connection
+  // attempt, the other WiFi libraries only count the late ones
+  void setDeadlines(const GoProDeadlines &deadlines, const uint8_t command = metric_commands);
+  const GoProDeadlines &deadlines(const uint8_t command) const;
+  // How long begin() and beginAsync() wait for the camera network
+  void setAssociateDeadline(const uint16_t ms);
+  // Stop the request on its way, from any task or callback: it only raises a
+  // flag. The next poll() ends the asynchronous one in front of the queue, its
+  // callback gets DEADLINE_CANCELLED, a blocking one returns at its next check
+  void cancel();
+  // What stopped the last request, DEADLINE_NONE if its answer arrived
+  uint8_t expired() const { return _expired; }
 
 // BLE functions are availables only on ESP32
 #if defined(ARDUINO_ARCH_ESP32)
@@ -102,11 +297,36 @@ public:
 
   // Control
   uint8_t turnOn();
+  // Wake the camera and wait until it is ready for the commands, ready gets the
+  // milliseconds it took. turnOn() is powerOn() with POWER_ON_DEADLINE
+  uint8_t powerOn(uint32_t &ready, const uint32_t deadline = POWER_ON_DEADLINE);
   uint8_t turnOff(const bool force = false);
 
   // Status
+  // The body of the answer, see GOPRO_NO_HEAP to know who owns it
   char *getStatus();
+  // Copy the body into a buffer of the caller: returns its length, 0 if it
+  // failed or it doesn't fit with the terminator
+  uint16_t getStatus(char *buffer, const uint16_t len);
+  uint8_t getStatus(GoProStatus &status);
+  // getStatus(GoProStatus &), isOn() and isRecording() are served from the last
+  // status for ttl milliseconds, 0 (default) asks the camera every time
+  void setStatusCache(const uint32_t ttl);
+  // Ask the camera unless the last status is still valid, changed gets the
+  // CHANGED_* fields which are different from the previous status
+  uint8_t refreshStatus(uint16_t &changed, const bool force = false);
   char *getMediaList();
+  uint16_t getMediaList(char *buffer, const uint16_t len);
+  uint8_t listMedia(GoProFileCallback on_file,
+                    void *context = nullptr,
+                    const GoProMediaFilter *filter = nullptr,
+                    GoProDirectoryCallback on_directory = nullptr);
+  // Stream /videos/DCIM/<directory>/<file> to the sink
+  uint8_t downloadMedia(const char *directory,
+                        const char *file,
+                        GoProDownloadSink sink,
+                        void *context = nullptr,
+                        GoProDownload *download = nullptr);
   bool isOn();
   bool isConnected(const bool silent = true);
   bool isRecording();
@@ -123,6 +343,11 @@ public:
   // Settings
   uint8_t setMode(const uint8_t option);
   uint8_t setOrientation(const uint8_t option);
+  // any option of Settings.h: setSetting(VR_1080p), setSetting(FR_60), ...
+  uint8_t setSetting(const uint8_t option);
+  // Send only the settings which are different from the status of the camera,
+  // saved gets the requests spared compared to sending every setting
+  uint8_t applyProfile(const GoProProfile &profile, int8_t &saved);
 
   // Video
   uint8_t setVideoResolution(const uint8_t option);
@@ -140,6 +365,59 @@ public:
   uint8_t localizationOff();
   uint8_t deleteLast();
   uint8_t deleteAll();
+  // Restart the live preview, the camera streams it to UDP port 8554, see
+  // GoProPreview
+  uint8_t startPreview();
+
+  // Asynchronous commands: they return at once with a handle (0 if the command
+  // can't be sent), call poll() from loop() and the callback gets the result
+  void poll();
+  bool isBusy();
+  uint8_t beginAsync(GoProCallback callback = nullptr, void *context = nullptr);
+  uint8_t turnOnAsync(GoProCallback callback = nullptr, void *context = nullptr);
+  uint8_t turnOffAsync(GoProCallback callback = nullptr, void *context = nullptr,
+                       const bool force = false);
+  uint8_t getStatusAsync(GoProCallback callback = nullptr, void *context = nullptr);
+  uint8_t getMediaListAsync(GoProCallback callback = nullptr, void *context = nullptr);
+  uint8_t shootAsync(GoProCallback callback = nullptr, void *context = nullptr);
+  uint8_t stopShootAsync(GoProCallback callback = nullptr, void *context = nullptr);
+  uint8_t setModeAsync(const uint8_t option, GoProCallback callback = nullptr,
+                       void *context = nullptr);
+  uint8_t setOrientationAsync(const uint8_t option, GoProCallback callback = nullptr,
+                              void *context = nullptr);
+  uint8_t setSettingAsync(const uint8_t option, GoProCallback callback = nullptr,
+                          void *context = nullptr);
+  uint8_t setVideoResolutionAsync(const uint8_t option, GoProCallback callback = nullptr,
+                                  void *context = nullptr);
+  uint8_t setVideoFovAsync(const uint8_t option, GoProCallback callback = nullptr,
+                           void *context = nullptr);
+  uint8_t setFrameRateAsync(const uint8_t option, GoProCallback callback = nullptr,
+                            void *context = nullptr);
+  uint8_t setVideoEncodingAsync(const uint8_t option, GoProCallback callback = nullptr,
+                                void *context = nullptr);
+  uint8_t setPhotoResolutionAsync(const uint8_t option, GoProCallback callback = nullptr,
+                                  void *context = nullptr);
+  uint8_t setTimeLapseIntervalAsync(float option, GoProCallback callback = nullptr,
+                                    void *context = nullptr);
+  uint8_t setContinuousShotAsync(const uint8_t option, GoProCallback callback = nullptr,
+                                 void *context = nullptr);
+  uint8_t localizationOnAsync(GoProCallback callback = nullptr, void *context = nullptr);
+  uint8_t localizationOffAsync(GoProCallback callback = nullptr, void *context = nullptr);
+  uint8_t deleteLastAsync(GoProCallback callback = nullptr, void *context = nullptr);
+  uint8_t deleteAllAsync(GoProCallback callback = nullptr, void *context = nullptr);
+
+  // Microseconds spent writing the last request, line and headers go out with
+  // a single write()
+  uint32_t sendTime() const { return _send_time; }
+
+#if GOPRO_METRICS
+  // Histograms of the connect time, time to first byte and total time of every
+  // kind of command and the error counters, metricsJson() serializes them
+  const GoProMetrics &metrics() const { return _metrics; }
+  void resetMetrics();
+#endif
+
+  static GoProFootprint footprint();
 
   // Debug
   void enableDebug(UniversalSerial *debug_port,
@@ -148,55 +426,253 @@ public:
   void printStatus();
 
 private:
+  friend class GoProPreview;
+
   WiFiClient _wifi_client;
   WiFiUDP _udp_client;
-  const char *_host = "10.5.5.9";
+  WiFiUDP _keep_alive_client; // open from the first keep-alive to end()
+  const char *_host = CAMERA_IP;
   const uint8_t _udp_port = 9;
 
   char *_ssid;
   char *_pwd;
+#if defined(GOPRO_CAMERA)
+  // a build for a single model (-DGOPRO_CAMERA=HERO7): every test on the camera
+  // is a constant, the code and the strings of the other generations are left
+  // out and the camera given to the constructor is ignored
+  static constexpr uint8_t _camera = GOPRO_CAMERA;
+#else
   uint8_t _camera;
+#endif
 
-  char *_request = new char[100];
-  char _response_buffer[MAX_RESPONSE_LEN];
-  char *_parameter = new char[2];
-  char *_sub_parameter = new char[2];
+#if GOPRO_LOW_RAM
+  // the request is sent before the answer comes: it stays in the buffer only
+  // until the first byte of the body, long enough to send it again if the
+  // keep-alive connection dropped
+  union
+  {
+    char _request[MAX_REQUEST_LEN];
+    char _response_buffer[MAX_RESPONSE_LEN];
+  };
+#else
+  char _request[MAX_REQUEST_LEN];
+  char _response_buffer[MAX_RESPONSE_LEN]; // body of the last response
+#endif
+  HTTPParser _parser;
+  uint16_t _body_len = 0;
+  bool _overflow = false;
+  HTTPBodyCallback _body_sink = nullptr; // where the body goes instead of the buffer
+  void *_body_context = nullptr;
+  uint32_t _range = 0;     // first byte asked by the next request, 0 for the whole body
+  uint32_t _range_end = 0; // byte after the last one asked, 0 for the end of the body
 
-  uint8_t _mode;
+  uint8_t _mode = 0;
 
-  uint8_t *_gopro_mac = new uint8_t[MAC_ADDRESS_LENGTH];
-  uint8_t *_board_mac = new uint8_t[MAC_ADDRESS_LENGTH];
-  char *_board_name = new char[20];
+  uint8_t _gopro_mac[MAC_ADDRESS_LENGTH];
+  uint8_t _board_mac[MAC_ADDRESS_LENGTH];
+  const char *_board_name = "";
 
   bool WIFI_MODE = true;
   bool BLE_ENABLED = false;
 
   bool _connected = false;
   bool _recording = false;
-  uint32_t _last_request;
+  uint32_t _last_request = 0;
+  uint32_t _send_time = 0;
+  bool _wol_open = false;
+  uint32_t _last_keep_alive = 0;
+  bool _keep_alive_open = false;
+  bool _previewing = false; // the stream needs the keep-alive whatever else is sent
+
+  // early completion
+  bool _early = false;
+  bool _code_only = false;   // the request being answered needs only the code
+  bool _draining = false;    // the rest of an answer which completed early
+  uint32_t _drain_end = 0;   // millis() of its body deadline
+
+  // deadlines
+  GoProDeadlines _deadlines[GOPRO_DEADLINE_SETS];
+  uint16_t _associate_deadline = ASSOCIATE_DEADLINE;
+  uint8_t _command = METRIC_OTHER; // kind of the request on its way
+  GoProDeadlines _deadline = {};   // of the request on its way
+  uint32_t _sent_at = 0;           // millis() of the request written
+  uint8_t _expired = DEADLINE_NONE;
+  bool _blocking = false; // a blocking request or begin() is waiting
+#if defined(__AVR__)
+  volatile bool _cancel = false; // a single byte, no task can tear it
+#else
+  std::atomic<bool> _cancel{false}; // raised by cancel() from any task
+#endif
+
+  // fast connect
+  bool _fast_connect = false;
+#if GOPRO_FAST_CONNECT
+  GoProLink _link;
+#endif
+  bool _link_valid = false;
+  GoProBootTiming _boot = {};
+  uint32_t _boot_start = 0; // micros() of begin()
+  uint32_t _boot_phase = 0; // micros() of the current association
+
+  // status cache
+  GoProStatus _status;
+  uint32_t _status_ttl = 0;
+  uint32_t _status_time = 0; // millis() of _status
+  bool _status_valid = false; // _status can be compared with the next one
+  bool _status_stale = true;  // a command may have changed the camera since
+
+  // keep-alive connection
+  bool _persistent = false;
+  bool _reused = false;
+  uint16_t _client_port = 0;
+  uint32_t _response_len = 0;
+
+  // asynchronous commands, a ring of requests served in order by poll()
+  enum AsyncState : uint8_t
+  {
+    ASYNC_IDLE,
+    ASYNC_ASSOCIATE,
+    ASYNC_CONNECT,
+    ASYNC_SEND,
+    ASYNC_RECEIVE
+  };
+  enum AsyncKind : uint8_t
+  {
+    ASYNC_COMMAND,
+    ASYNC_BEGIN,
+    ASYNC_SHOOT,
+    ASYNC_STOP_SHOOT
+  };
+#if GOPRO_ASYNC_SLOTS > 0
+  struct AsyncRequest
+  {
+    char request[MAX_REQUEST_LEN];
+    uint16_t port;
+    uint8_t handle;
+    uint8_t kind;
+    uint8_t attempt;
+    bool code_only;
+    uint32_t start; // micros() of the *Async() call
+    GoProCallback callback;
+    void *context;
+  };
+  AsyncRequest _async[GOPRO_ASYNC_SLOTS];
+  static constexpr uint8_t _async_ring = GOPRO_ASYNC_SLOTS;
+#endif
+  uint8_t _async_head = 0;
+  uint8_t _async_count = 0;
+  uint8_t _async_state = ASYNC_IDLE;
+  uint8_t _async_handle = 0;  // last handle given
+  uint32_t _async_phase = 0;  // millis() at the start of the association
+  bool _defer = false;        // queue the next HTTP request instead of sending it
+  uint8_t _deferred = 0;      // handle of the request queued while _defer was set
+
+  // a body which goes to the buffer of the caller
+  struct BodyCopy
+  {
+    char *buffer;
+    uint16_t len;
+    uint16_t used;
+    bool overflow;
+  };
+
+  // a download on its way, the chunks are the two halves of _response_buffer
+  struct DownloadStream
+  {
+    GoProControl *gp;
+    GoProDownload *download;
+    GoProDownloadSink sink;
+    void *context;
+    uint32_t offset; // in the file of the chunk being filled
+    uint16_t fill;
+    uint8_t half;
+    bool started; // the first bytes of this response arrived
+    bool failed;
+    bool reached; // until arrived, the rest of an answer which ignored the Range isn't read
+  };
+  static_assert(2 * DOWNLOAD_CHUNK_LEN <= MAX_RESPONSE_LEN, "the chunks don't fit the buffer");
+
+#if GOPRO_METRICS
+  GoProMetrics _metrics = {};
+  uint8_t _metric_command = metric_commands; // metric_commands: no request is timed
+  uint32_t _metric_start = 0;                // micros() of the request
+  uint32_t _metric_connect = 0;              // spent connecting
+  uint32_t _metric_sent = 0;                 // micros() of the last write, 0 before
+  uint32_t _metric_send = 0;                 // spent writing
+  uint32_t _metric_first = 0;                // micros() of the first byte, 0 before
+#endif
 
-  UniversalSerial *_debug_port;
-  bool _debug;
+  UniversalSerial *_debug_port = nullptr;
+  bool _debug = false;
 
-  void sendWoL();
-  uint8_t sendRequest(const char *request, bool silent = true);
+  void sendWoL(const uint8_t packets = 1);
+  bool sendKeepAlive();
   bool handleHTTPRequest(const char *request);
+  // deadlines replaces the ones of the kind of the request
+  bool requestResponse(const char *request, const uint16_t port = 80,
+                       const GoProDeadlines *deadlines = nullptr);
   bool sendHTTPRequest(const char *request, const uint16_t port = 80);
+  void writeHTTPRequest(const char *request, const uint16_t port);
+  uint16_t renderHTTPRequest(char *buff, const char *request, const uint16_t port);
 #if defined(ARDUINO_ARCH_ESP32)
   uint8_t sendBLERequest(const uint8_t request[]);
 #endif
   uint8_t connectClient(const uint16_t port = 80);
-  bool listenResponse(const bool mediatimer = false);
-  uint16_t extractResponselength();
+  void closeClient();
+  bool listenResponse();
+  void beginResponse();
+  bool readResponse();
+  bool endResponse();
+  bool answeredEarly();
+  bool drainResponse();
+  void startRequest(const char *request, const GoProDeadlines *deadlines = nullptr);
+  bool beginBlocking();
+  bool takeCancel();
+  void cancelAsync();
+  bool responseExpired(const uint32_t since);
+  static uint8_t deadlineSet(const uint8_t command);
+  static void storeBody(void *context, const char *data, uint16_t len);
+  static void downloadBody(void *context, const char *data, uint16_t len);
+  void flushDownload(DownloadStream &stream);
   uint16_t extractResponseCode();
+  bool deferRequest(const uint8_t kind, GoProCallback callback, void *context);
+  void queueRequest(const char *request, const uint16_t port);
+  uint8_t queuedRequest();
+  bool stepAsync();
+  void completeAsync(const uint16_t code);
+  void flushAsync();
+  void metricStart();
+  void metricConnected(const uint32_t start, const bool connected, const bool late);
+  void metricSent(const uint32_t send);
+  void metricFirstByte();
+  void metricReconnect();
+  void metricWake(const uint32_t ready, const bool woke);
+  void metricAssociate();
+  void metricEnd();
+  bool requestStatus();
+  bool requestMediaList();
+  char *bodyString();
+  static void copyBody(void *context, const char *data, uint16_t len);
+  uint16_t endCopy(const bool answered, BodyCopy &copy);
+  uint8_t fetchStatus(GoProStatus &status, const GoProDeadlines *deadlines = nullptr);
+  bool statusCached();
+  void startAssociation();
+  void fallbackAssociation();
+  void finishAssociation();
+  void storeLink();
   void getBSSID();
   void getWiFiData();
+  uint8_t applySetting(const uint8_t kind, const uint8_t option);
+  uint8_t settingOption(const uint8_t kind, const uint8_t code);
+  void appendNumber(char *buff, const uint8_t number, const bool hex);
   void revert(uint8_t arr[]);
-  void makeRequest(char *buff,
+  // false if it doesn't fit MAX_REQUEST_LEN with extra more characters
+  bool makeRequest(char *buff,
                    const char *a,
                    const char *b = nullptr,
                    const char *c = nullptr,
-                   const char *d = nullptr);
+                   const char *d = nullptr,
+                   const uint8_t extra = 0);
 };
 
 #endif // GOPRO_CONTROL_H
@@ -0,0 +1,177 @@
+/*
+GoProFleet.cpp
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <GoProFleet.h>
+
+uint8_t GoProFleet::add(GoProControl &camera)
+{
+  if (_count == GOPRO_FLEET_SIZE)
+  {
+    return false;
+  }
+  _cameras[_count] = &camera;
+  _shots[_count] = {false, 0, 0, 0, 0};
+  _count++;
+  return true;
+}
+
+uint8_t GoProFleet::arm()
+{
+  uint8_t result = true;
+  for (uint8_t i = 0; i < _count; i++)
+  {
+    _cameras[i]->setPersistentConnection(true);
+    if (!_cameras[i]->openConnection())
+    {
+      result = false;
+    }
+  }
+  return result;
+}
+
+uint8_t GoProFleet::shoot()
+{
+  return trigger(true);
+}
+
+uint8_t GoProFleet::stopShoot()
+{
+  return trigger(false);
+}
+
+void GoProFleet::end()
+{
+  for (uint8_t i = 0; i < _count; i++)
+  {
+    _cameras[i]->setPersistentConnection(false);
+  }
+}
+
+uint16_t GoProFleet::code(const uint8_t index) const
+{
+  return index < _count ? _shots[index].code : 0;
+}
+
+uint32_t GoProFleet::sentAt(const uint8_t index) const
+{
+  return index < _count ? _shots[index].sent : 0;
+}
+
+uint32_t GoProFleet::ackAt(const uint8_t index) const
+{
+  return index < _count ? _shots[index].ack : 0;
+}
+
+uint32_t GoProFleet::skew() const
+{
+  uint8_t answered = 0;
+  uint32_t first = 0;
+  uint32_t last = 0;
+  for (uint8_t i = 0; i < _count; i++)
+  {
+    if (_shots[i].code != 200)
+    {
+      continue;
+    }
+    if (answered == 0 || _shots[i].ack < first)
+    {
+      first = _shots[i].ack;
+    }
+    if (answered == 0 || _shots[i].ack > last)
+    {
+      last = _shots[i].ack;
+    }
+    answered++;
+  }
+  return answered < 2 ? 0 : last - first;
+}
+
+uint8_t GoProFleet::trigger(const bool start)
+{
+  for (uint8_t i = 0; i < _count; i++)
+  {
+    _shots[i] = {false, 0, 0, 0, 0};
+  }
+  // a request behind another one in its queue would go out late
+  for (uint8_t i = 0; i < _count; i++)
+  {
+    if (GOPRO_ASYNC_SLOTS == 0 || _cameras[i]->isBusy())
+    {
+      return false;
+    }
+  }
+
+  // build and queue every request before the first one goes out
+  for (uint8_t i = 0; i < _count; i++)
+  {
+    uint8_t handle = start ? _cameras[i]->shootAsync(onAck, &_shots[i])
+                           : _cameras[i]->stopShootAsync(onAck, &_shots[i]);
+    _shots[i].done = handle == 0;
+  }
+
+  // the first poll() of each camera writes its request on the open connection
+  const uint32_t start_time = micros();
+  for (uint8_t i = 0; i < _count; i++)
+  {
+    _shots[i].start = start_time;
+  }
+  for (uint8_t i = 0; i < _count; i++)
+  {
+    if (!_shots[i].done)
+    {
+      _cameras[i]->poll();
+      _shots[i].sent = micros() - start_time;
+    }
+  }
+
+  bool pending = true;
+  while (pending)
+  {
+    pending = false;
+    for (uint8_t i = 0; i < _count; i++)
+    {
+      if (!_shots[i].done)
+      {
+        _cameras[i]->poll();
+        pending = pending || !_shots[i].done;
+      }
+    }
+    yield();
+  }
+
+  uint8_t result = _count > 0;
+  for (uint8_t i = 0; i < _count; i++)
+  {
+    if (_shots[i].code != 200)
+    {
+      result = false;
+    }
+  }
+  return result;
+}
+
+void GoProFleet::onAck(void *context, const GoProResult &result)
+{
+  Shot *shot = (Shot *)context;
+  shot->done = true;
+  shot->code = result.code;
+  shot->ack = micros() - shot->start;
+}
@@ -0,0 +1,76 @@
+/*
+GoProFleet.h
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef GOPRO_FLEET_H
+#define GOPRO_FLEET_H
+
+#include <GoProControl.h>
+
+// how many cameras a GoProFleet can hold
+#if !defined(GOPRO_FLEET_SIZE)
+#define GOPRO_FLEET_SIZE 4
+#endif
+
+// Shutter of many cameras at once: the requests of every camera are built
+// first, then written one after the other on connections opened by arm(), and
+// the acknowledge of each camera is timed to know how far apart they started
+class GoProFleet
+{
+public:
+  // The cameras must live as long as the fleet, begin() them before arm()
+  uint8_t add(GoProControl &camera);
+  uint8_t size() const { return _count; }
+
+  // Open a keep-alive connection to every camera, call it again after end()
+  uint8_t arm();
+  // Both return true if every camera answered 200. They fail at once if a
+  // camera isBusy(), or with GOPRO_ASYNC_SLOTS 0
+  uint8_t shoot();
+  uint8_t stopShoot();
+  void end();
+
+  // Of the last shoot() or stopShoot(), in microseconds from its start
+  uint16_t code(const uint8_t index) const;
+  uint32_t sentAt(const uint8_t index) const;
+  uint32_t ackAt(const uint8_t index) const;
+  // Between the first and the last acknowledge, 0 if less than two cameras
+  // answered
+  uint32_t skew() const;
+
+private:
+  struct Shot
+  {
+    bool done;
+    uint16_t code;
+    uint32_t start; // micros() of the first write of the fleet
+    uint32_t sent;
+    uint32_t ack;
+  };
+
+  GoProControl *_cameras[GOPRO_FLEET_SIZE];
+  Shot _shots[GOPRO_FLEET_SIZE];
+  uint8_t _count = 0;
+
+  uint8_t trigger(const bool start);
+  static void onAck(void *context, const GoProResult &result);
+};
+
+#endif // GOPRO_FLEET_H
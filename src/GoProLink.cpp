@@ -0,0 +1,117 @@
+/*
+GoProLink.cpp
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include <GoProLink.h>
+
+#if defined(ARDUINO_ARCH_ESP32)
+#include <Preferences.h>
+#elif defined(ARDUINO_ARCH_ESP8266)
+#include <EEPROM.h>
+#elif defined(GOPRO_HOST)
+#include <stdio.h>
+#endif
+
+uint32_t linkHash(const char *ssid)
+{
+  uint32_t hash = 2166136261UL; // FNV-1a
+  while (*ssid != '\0')
+  {
+    hash = (hash ^ (uint8_t)*ssid++) * 16777619UL;
+  }
+  return hash;
+}
+
+bool loadLink(GoProLink &link, const char *ssid)
+{
+  bool read = false;
+#if defined(ARDUINO_ARCH_ESP32)
+  Preferences nvs;
+  if (nvs.begin("gopro", true))
+  {
+    read = nvs.getBytes("link", &link, sizeof(link)) == sizeof(link);
+    nvs.end();
+  }
+#elif defined(ARDUINO_ARCH_ESP8266)
+  EEPROM.begin(GOPRO_LINK_EEPROM_ADDRESS + sizeof(link));
+  EEPROM.get(GOPRO_LINK_EEPROM_ADDRESS, link);
+  EEPROM.end();
+  read = true;
+#elif defined(GOPRO_HOST)
+  FILE *file = fopen(GOPRO_LINK_FILE, "rb");
+  if (file != nullptr)
+  {
+    read = fread(&link, sizeof(link), 1, file) == 1;
+    fclose(file);
+  }
+#else
+  (void)link;
+#endif
+  return read && link.magic == GOPRO_LINK_MAGIC && link.ssid_hash == linkHash(ssid) &&
+         link.channel != 0 && link.ip[0] != 0;
+}
+
+bool saveLink(const GoProLink &link)
+{
+#if defined(ARDUINO_ARCH_ESP32)
+  Preferences nvs;
+  if (!nvs.begin("gopro", false))
+  {
+    return false;
+  }
+  const bool written = nvs.putBytes("link", &link, sizeof(link)) == sizeof(link);
+  nvs.end();
+  return written;
+#elif defined(ARDUINO_ARCH_ESP8266)
+  EEPROM.begin(GOPRO_LINK_EEPROM_ADDRESS + sizeof(link));
+  EEPROM.put(GOPRO_LINK_EEPROM_ADDRESS, link);
+  return EEPROM.end(); // commits
+#elif defined(GOPRO_HOST)
+  FILE *file = fopen(GOPRO_LINK_FILE, "wb");
+  if (file == nullptr)
+  {
+    return false;
+  }
+  const bool written = fwrite(&link, sizeof(link), 1, file) == 1;
+  return fclose(file) == 0 && written;
+#else
+  (void)link;
+  return false;
+#endif
+}
+
+void eraseLink()
+{
+#if defined(ARDUINO_ARCH_ESP32)
+  Preferences nvs;
+  if (nvs.begin("gopro", false))
+  {
+    nvs.remove("link");
+    nvs.end();
+  }
+#elif defined(ARDUINO_ARCH_ESP8266)
+  GoProLink link;
+  memset(&link, 0, sizeof(link));
+  saveLink(link);
+#elif defined(GOPRO_HOST)
+  remove(GOPRO_LINK_FILE);
+#endif
+}
@@ -0,0 +1,82 @@
+/*
+GoProLink.h
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#ifndef GOPRO_LINK_H
+#define GOPRO_LINK_H
+
+#include <Arduino.h>
+
+// only these WiFi libraries can join a given BSSID on a given channel
+#if !defined(GOPRO_FAST_CONNECT)
+#if defined(ARDUINO_ARCH_ESP32) || defined(ARDUINO_ARCH_ESP8266) || defined(GOPRO_HOST)
+#define GOPRO_FAST_CONNECT 1
+#else
+#define GOPRO_FAST_CONNECT 0
+#endif
+#endif
+
+// milliseconds given to the association with the stored link before a full one
+#if !defined(FAST_CONNECT_WAIT)
+#define FAST_CONNECT_WAIT 1000
+#endif
+
+// where the link is kept: an EEPROM address on the ESP8266, a file on the host
+#if !defined(GOPRO_LINK_EEPROM_ADDRESS)
+#define GOPRO_LINK_EEPROM_ADDRESS 0
+#endif
+#if !defined(GOPRO_LINK_FILE)
+#define GOPRO_LINK_FILE "/tmp/gopro_link.bin"
+#endif
+
+#define GOPRO_LINK_MAGIC 0x474C // changes with the layout of GoProLink
+
+// What the camera network gave us the last time, enough to join it again
+// without a scan and without DHCP
+struct GoProLink
+{
+  uint16_t magic;
+  uint32_t ssid_hash; // the link of another camera is never used
+  uint8_t bssid[6];   // as WiFi.BSSID() gives it, all 0 if unknown
+  uint8_t channel;
+  uint8_t ip[4]; // of the board
+  uint8_t gateway[4];
+  uint8_t subnet[4];
+};
+
+// Microseconds spent in every phase of the last begin()
+struct GoProBootTiming
+{
+  uint32_t load;     // reading the stored link
+  uint32_t directed; // joining the stored BSSID and channel with a static IP
+  uint32_t full;     // scan, association and DHCP, 0 if the directed join worked
+  uint32_t save;     // writing the new link, only when it changed
+  uint32_t total;
+  bool fast; // connected with the stored link
+};
+
+uint32_t linkHash(const char *ssid);
+// false if nothing valid for this SSID is stored
+bool loadLink(GoProLink &link, const char *ssid);
+bool saveLink(const GoProLink &link);
+void eraseLink();
+
+#endif // GOPRO_LINK_H
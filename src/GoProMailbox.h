@@ -0,0 +1,114 @@
+/*
+GoProMailbox.h
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#ifndef GOPRO_MAILBOX_H
+#define GOPRO_MAILBOX_H
+
+#include <Arduino.h>
+#include <atomic>
+
+// Bounded queue which many tasks can push to and pop from without a lock:
+// every cell carries a sequence number which tells whether it is free, full,
+// or taken by a task which is still copying the item. N must be a power of two
+template <typename T, uint8_t N>
+class GoProMailbox
+{
+  static_assert(N >= 2 && (N & (N - 1)) == 0, "the size of a mailbox must be a power of two");
+
+public:
+  GoProMailbox()
+  {
+    for (uint8_t i = 0; i < N; i++)
+    {
+      _cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  // False if the mailbox is full
+  bool push(const T &item)
+  {
+    uint32_t position = _tail.load(std::memory_order_relaxed);
+    for (;;)
+    {
+      Cell &cell = _cells[position & (N - 1)];
+      const int32_t diff = (int32_t)(cell.sequence.load(std::memory_order_acquire) - position);
+      if (diff == 0)
+      {
+        if (_tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+        {
+          cell.item = item;
+          cell.sequence.store(position + 1, std::memory_order_release);
+          return true;
+        }
+      }
+      else if (diff < 0)
+      {
+        return false;
+      }
+      else
+      {
+        position = _tail.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  // False if the mailbox is empty
+  bool pop(T &item)
+  {
+    uint32_t position = _head.load(std::memory_order_relaxed);
+    for (;;)
+    {
+      Cell &cell = _cells[position & (N - 1)];
+      const int32_t diff = (int32_t)(cell.sequence.load(std::memory_order_acquire) - (position + 1));
+      if (diff == 0)
+      {
+        if (_head.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+        {
+          item = cell.item;
+          cell.sequence.store(position + N, std::memory_order_release);
+          return true;
+        }
+      }
+      else if (diff < 0)
+      {
+        return false;
+      }
+      else
+      {
+        position = _head.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+private:
+  struct Cell
+  {
+    std::atomic<uint32_t> sequence;
+    T item;
+  };
+
+  Cell _cells[N];
+  std::atomic<uint32_t> _tail{0};
+  std::atomic<uint32_t> _head{0};
+};
+
+#endif // GOPRO_MAILBOX_H
@@ -0,0 +1,219 @@
+/*
+GoProMetrics.cpp
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+
+#include <GoProMetrics.h>
+
+struct MetricPath
+{
+  char fragment[17];
+  uint8_t command;
+};
+
+// the first fragment found in the path wins, HERO3 and HERO4 and newer. In
+// flash on AVR, the deadlines need it on every board
+static const MetricPath metric_paths[] PROGMEM = {
+    {"command/shutter", METRIC_SHUTTER},
+    {"bacpac/SH", METRIC_SHUTTER},
+    {"command/mode", METRIC_MODE},
+    {"command/sub_mode", METRIC_MODE},
+    {"/camera/CM", METRIC_MODE},
+    {"/setting/", METRIC_SETTING},
+    {"gpControl/status", METRIC_STATUS},
+    {"/camera/sx", METRIC_STATUS},
+    {"gpMediaList", METRIC_MEDIA},
+    {"/videos/DCIM/", METRIC_DOWNLOAD},
+    {"system/sleep", METRIC_POWER},
+    {"bacpac/PW", METRIC_POWER},
+    {"/camera/", METRIC_SETTING},
+};
+
+uint8_t metricCommand(const char *request)
+{
+  for (uint8_t i = 0; i < sizeof(metric_paths) / sizeof(metric_paths[0]); i++)
+  {
+#if defined(__AVR__)
+    if (strstr_P(request, metric_paths[i].fragment) != nullptr)
+    {
+      return pgm_read_byte(&metric_paths[i].command);
+    }
+#else
+    if (strstr(request, metric_paths[i].fragment) != nullptr)
+    {
+      return metric_paths[i].command;
+    }
+#endif
+  }
+  return METRIC_OTHER;
+}
+
+#if GOPRO_METRICS
+
+#include <stdarg.h>
+
+static const char *const metric_names[metric_commands] = {
+    "shutter", "mode", "setting", "status", "media", "download", "power", "other"};
+
+void GoProHistogram::add(const uint32_t us)
+{
+  uint8_t bucket = 0;
+  if (us >= METRIC_FIRST_BUCKET_US)
+  {
+    // log2, __builtin_clz() takes an int which is 16 bits on AVR
+    bucket = sizeof(unsigned long) * 8 - 1 - __builtin_clzl(us) - 7;
+    if (bucket >= METRIC_BUCKETS)
+    {
+      bucket = METRIC_BUCKETS - 1;
+    }
+  }
+  count[bucket]++;
+}
+
+uint32_t GoProHistogram::samples() const
+{
+  uint32_t n = 0;
+  for (uint8_t i = 0; i < METRIC_BUCKETS; i++)
+  {
+    n += count[i];
+  }
+  return n;
+}
+
+uint32_t GoProHistogram::percentile(const uint8_t p) const
+{
+  const uint32_t n = samples();
+  if (n == 0)
+  {
+    return 0;
+  }
+  const uint32_t wanted = ((uint64_t)n * p + 99) / 100;
+  uint32_t seen = 0;
+  for (uint8_t i = 0; i < METRIC_BUCKETS; i++)
+  {
+    seen += count[i];
+    if (seen >= wanted && seen > 0)
+    {
+      return (uint32_t)METRIC_FIRST_BUCKET_US << i;
+    }
+  }
+  return (uint32_t)METRIC_FIRST_BUCKET_US << (METRIC_BUCKETS - 1);
+}
+
+const char *metricName(const uint8_t command)
+{
+  return command < metric_commands ? metric_names[command] : "";
+}
+
+static bool append(char *buffer, const uint16_t len, uint16_t &pos, const char *format, ...)
+{
+  va_list args;
+  va_start(args, format);
+  const int n = vsnprintf(buffer + pos, len - pos, format, args);
+  va_end(args);
+  if (n < 0 || pos + n >= len)
+  {
+    return false;
+  }
+  pos += n;
+  return true;
+}
+
+static bool appendHistogram(char *buffer, const uint16_t len, uint16_t &pos, const char *name,
+                            const GoProHistogram &histogram)
+{
+  uint8_t used = METRIC_BUCKETS;
+  while (used > 0 && histogram.count[used - 1] == 0)
+  {
+    used--;
+  }
+  if (!append(buffer, len, pos, ",\"%s\":[", name))
+  {
+    return false;
+  }
+  for (uint8_t i = 0; i < used; i++)
+  {
+    if (!append(buffer, len, pos, i == 0 ? "%lu" : ",%lu", (unsigned long)histogram.count[i]))
+    {
+      return false;
+    }
+  }
+  return append(buffer, len, pos, "]");
+}
+
+uint16_t metricsJson(const GoProMetrics &metrics, char *buffer, const uint16_t len)
+{
+  uint16_t pos = 0;
+  if (len == 0 || !append(buffer, len, pos, "{\"bucket_us\":%u", METRIC_FIRST_BUCKET_US))
+  {
+    return 0;
+  }
+  for (uint8_t i = 0; i < metric_commands; i++)
+  {
+    const GoProCommandMetrics &command = metrics.commands[i];
+    if (command.requests == 0)
+    {
+      continue;
+    }
+    if (!append(buffer, len, pos, ",\"%s\":{\"requests\":%lu", metric_names[i],
+                (unsigned long)command.requests) ||
+        !appendHistogram(buffer, len, pos, "connect", command.connect) ||
+        !appendHistogram(buffer, len, pos, "send", command.send) ||
+        !appendHistogram(buffer, len, pos, "first_byte", command.first_byte) ||
+        !appendHistogram(buffer, len, pos, "total", command.total))
+    {
+      return 0;
+    }
+    if ((command.late_connect | command.late_first_byte | command.late_body |
+         command.cancelled) != 0 &&
+        !append(buffer, len, pos,
+                ",\"late_connect\":%lu,\"late_first_byte\":%lu,\"late_body\":%lu,"
+                "\"cancelled\":%lu",
+                (unsigned long)command.late_connect, (unsigned long)command.late_first_byte,
+                (unsigned long)command.late_body, (unsigned long)command.cancelled))
+    {
+      return 0;
+    }
+    if (!append(buffer, len, pos, "}"))
+    {
+      return 0;
+    }
+  }
+  if (metrics.wake.samples() > 0 && !appendHistogram(buffer, len, pos, "wake", metrics.wake))
+  {
+    return 0;
+  }
+  if (!append(buffer, len, pos,
+              ",\"timeouts\":%lu,\"reconnects\":%lu,\"connect_failures\":%lu,\"code_400\":%lu,"
+              "\"code_403\":%lu,\"code_410\":%lu,\"code_other\":%lu,\"overflows\":%lu,"
+              "\"wake_failures\":%lu,\"late_associate\":%lu}",
+              (unsigned long)metrics.timeouts, (unsigned long)metrics.reconnects,
+              (unsigned long)metrics.connect_failures, (unsigned long)metrics.code_400,
+              (unsigned long)metrics.code_403, (unsigned long)metrics.code_410,
+              (unsigned long)metrics.code_other, (unsigned long)metrics.overflows,
+              (unsigned long)metrics.wake_failures, (unsigned long)metrics.late_associate))
+  {
+    return 0;
+  }
+  return pos;
+}
+
+#endif // GOPRO_METRICS
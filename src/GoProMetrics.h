@@ -0,0 +1,107 @@
+/*
+GoProMetrics.h
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#ifndef GOPRO_METRICS_H
+#define GOPRO_METRICS_H
+
+#include <Arduino.h>
+
+// the counters take about 2.3 kB (footprint().metrics), too much for an AVR
+#if !defined(GOPRO_METRICS)
+#if defined(__AVR__)
+#define GOPRO_METRICS 0
+#else
+#define GOPRO_METRICS 1
+#endif
+#endif
+
+// What a request was for, from its path: the metrics and the deadlines are
+// kept for every kind
+enum metric_command : uint8_t
+{
+  METRIC_SHUTTER,
+  METRIC_MODE,
+  METRIC_SETTING,
+  METRIC_STATUS,
+  METRIC_MEDIA,
+  METRIC_DOWNLOAD,
+  METRIC_POWER,
+  METRIC_OTHER,
+  metric_commands
+};
+
+uint8_t metricCommand(const char *request);
+
+#if GOPRO_METRICS
+
+// bucket 0 counts what took less than 256 us, every next one doubles: bucket i
+// goes up to 2^(i + 8) us, the last one counts everything above 4 seconds
+#define METRIC_BUCKETS 16
+#define METRIC_FIRST_BUCKET_US 256
+
+struct GoProHistogram
+{
+  uint32_t count[METRIC_BUCKETS];
+
+  void add(const uint32_t us);
+  uint32_t samples() const;
+  // Upper bound of the bucket which holds the percentile p (0..100), in us
+  uint32_t percentile(const uint8_t p) const;
+};
+
+struct GoProCommandMetrics
+{
+  uint32_t requests;
+  GoProHistogram connect;    // TCP connection, close to 0 when it was kept open
+  GoProHistogram send;       // writing the request line and the headers
+  GoProHistogram first_byte; // from the request written to the first byte of the answer
+  GoProHistogram total;      // from the start of the request to the end of the answer
+  uint32_t late_connect;     // connections which missed their deadline
+  uint32_t late_first_byte;  // answers which didn't start before their deadline
+  uint32_t late_body;        // answers which didn't end before their deadline
+  uint32_t cancelled;        // by cancel()
+};
+
+struct GoProMetrics
+{
+  GoProCommandMetrics commands[metric_commands];
+  uint32_t timeouts;         // no complete answer before the deadlines
+  uint32_t late_associate;   // begin() which missed the association deadline
+  uint32_t reconnects;       // keep-alive connections dropped by the camera
+  uint32_t connect_failures;
+  uint32_t code_400;         // bad request
+  uint32_t code_403;         // wrong password
+  uint32_t code_410;         // failed
+  uint32_t code_other;       // any other code which is not 2xx
+  uint32_t overflows;        // bodies longer than the response buffer
+  GoProHistogram wake;       // from the magic packet to the camera ready, powerOn()
+  uint32_t wake_failures;    // cameras not ready before the deadline
+};
+
+const char *metricName(const uint8_t command);
+// The metrics as compact JSON, empty commands and trailing empty buckets are
+// left out. Returns the length, 0 if the buffer is too short
+uint16_t metricsJson(const GoProMetrics &metrics, char *buffer, const uint16_t len);
+
+#endif // GOPRO_METRICS
+
+#endif // GOPRO_METRICS_H
@@ -0,0 +1,152 @@
+/*
+GoProOffload.cpp
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <GoProOffload.h>
+
+#if defined(GOPRO_HOST)
+
+#include <atomic>
+#include <fcntl.h>
+#include <memory>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+struct OffloadFile
+{
+  int fd;
+  std::atomic<bool> failed; // written by all the connections
+};
+
+static bool writeAt(void *context, uint32_t offset, const uint8_t *data, uint16_t len)
+{
+  OffloadFile *out = (OffloadFile *)context;
+  if (pwrite(out->fd, data, len, offset) != len)
+  {
+    out->failed = true;
+  }
+  return !out->failed;
+}
+
+GoProOffload::GoProOffload(const char *ssid, const char *pwd, const uint8_t camera)
+    : _ssid(ssid), _pwd(pwd), _camera(camera)
+{
+}
+
+uint8_t GoProOffload::download(const char *directory,
+                               const char *file,
+                               const char *path,
+                               const uint8_t connections,
+                               GoProOffloadResult *result)
+{
+  if (connections == 0 || connections > GOPRO_OFFLOAD_CONNECTIONS)
+  {
+    return -1;
+  }
+
+  OffloadFile out;
+  out.fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  out.failed = false;
+  if (out.fd < 0)
+  {
+    return false;
+  }
+  const uint32_t start_time = millis();
+
+  // every connection is a camera of its own, with its own client and buffers
+  std::vector<std::unique_ptr<GoProControl>> cameras;
+  auto endAll = [&cameras] {
+    for (std::unique_ptr<GoProControl> &camera : cameras)
+    {
+      camera->end();
+    }
+  };
+  for (uint8_t i = 0; i < connections; i++)
+  {
+    cameras.emplace_back(new GoProControl(_ssid, _pwd, _camera));
+    if (cameras[i]->begin() != true)
+    {
+      endAll();
+      close(out.fd);
+      return false;
+    }
+  }
+
+  // the first byte tells the size of the file, a camera which ignores the
+  // Range answers 200 and the download stops after that byte all the same
+  GoProDownload probe = {0, 1, 0, 0, 0, 0};
+  if (!cameras[0]->downloadMedia(directory, file, writeAt, &out, &probe) || probe.size == 0 ||
+      ftruncate(out.fd, probe.size) != 0)
+  {
+    endAll();
+    close(out.fd);
+    return false;
+  }
+
+  // a file of one byte came whole with the probe
+  uint8_t used = probe.size > 1 ? connections : 0;
+  const uint32_t min_range = 64 * 1024; // below this a connection costs more than it gives
+  while (used > 1 && probe.size / used < min_range)
+  {
+    used--;
+  }
+
+  std::vector<GoProDownload> ranges(used);
+  std::vector<uint8_t> done(used, false);
+  std::vector<std::thread> workers;
+  const uint32_t step = used > 0 ? (probe.size + used - 1) / used : 0;
+  for (uint8_t i = 0; i < used; i++)
+  {
+    const uint32_t first = i == 0 ? 1 : i * step; // the probe has the first byte
+    const uint32_t until = i == used - 1 ? probe.size : (i + 1) * step;
+    ranges[i] = {first, until, 0, 0, 0, 0};
+    workers.emplace_back([&, i] {
+      done[i] = cameras[i]->downloadMedia(directory, file, writeAt, &out, &ranges[i]) == true;
+    });
+  }
+
+  bool complete = true;
+  uint8_t resumes = 0;
+  for (uint8_t i = 0; i < used; i++)
+  {
+    workers[i].join();
+    complete = complete && done[i] && ranges[i].received == ranges[i].until;
+    resumes += ranges[i].resumes;
+  }
+  endAll();
+  complete = close(out.fd) == 0 && complete && !out.failed;
+
+  if (result != nullptr)
+  {
+    result->size = probe.size;
+    result->connections = used > 0 ? used : 1;
+    result->resumes = resumes;
+    result->elapsed = millis() - start_time;
+    result->throughput = 0;
+    if (result->elapsed > 0)
+    {
+      result->throughput = (uint64_t)probe.size * 1000 / result->elapsed;
+    }
+  }
+  return complete;
+}
+
+#endif // GOPRO_HOST
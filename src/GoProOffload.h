@@ -0,0 +1,64 @@
+/*
+GoProOffload.h
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef GOPRO_OFFLOAD_H
+#define GOPRO_OFFLOAD_H
+
+// Only for the Linux build (extras/host): an offload station which empties
+// the SD card of the cameras into files
+#if defined(GOPRO_HOST)
+
+#include <GoProControl.h>
+
+#define GOPRO_OFFLOAD_CONNECTIONS 8 // most connections to a camera at once
+
+struct GoProOffloadResult
+{
+  uint32_t size;        // of the file
+  uint8_t connections;  // used, a small file gets less than asked
+  uint8_t resumes;      // of all the connections together
+  uint32_t elapsed;     // milliseconds
+  uint32_t throughput;  // bytes per second of all the connections together
+};
+
+// Download of a big file over many connections at once: every connection asks
+// its own byte range with downloadMedia() and writes it straight at its place
+// in the output file with pwrite(), there is nothing to put back together
+class GoProOffload
+{
+public:
+  GoProOffload(const char *ssid, const char *pwd, const uint8_t camera);
+
+  uint8_t download(const char *directory,
+                   const char *file,
+                   const char *path,
+                   const uint8_t connections = 4,
+                   GoProOffloadResult *result = nullptr);
+
+private:
+  const char *_ssid;
+  const char *_pwd;
+  const uint8_t _camera;
+};
+
+#endif // GOPRO_HOST
+
+#endif // GOPRO_OFFLOAD_H
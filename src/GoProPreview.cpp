@@ -0,0 +1,190 @@
+/*
+GoProPreview.cpp
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include <GoProPreview.h>
+
+#define TS_SYNC_BYTE 0x47
+#define TS_NULL_PID 0x1FFF
+
+uint8_t GoProPreview::begin(GoProPacketCallback callback, void *context)
+{
+  end();
+  if (!_gp.startPreview())
+  {
+    return false;
+  }
+  // opens the port the camera streams to
+  if (!_gp.sendKeepAlive())
+  {
+    if (_gp._debug)
+    {
+      _gp._debug_port->println(F("Can't open the preview port"));
+    }
+    return false;
+  }
+
+  _callback = callback;
+  _context = context;
+  _streaming = true;
+  _gp._previewing = true;
+  resetStats();
+  _last_packet = millis();
+  return true;
+}
+
+void GoProPreview::end()
+{
+  if (_streaming)
+  {
+    _gp._previewing = false;
+    _streaming = false;
+  }
+}
+
+void GoProPreview::poll()
+{
+  if (!_streaming)
+  {
+    return;
+  }
+
+  // at most a lap of the ring, so that the packets given stay valid
+  for (uint8_t i = 0; i < GOPRO_PREVIEW_SLOTS; i++)
+  {
+    const int len = _gp._keep_alive_client.parsePacket();
+    if (len <= 0)
+    {
+      break;
+    }
+    uint8_t *packet = _packets[_slot];
+    _slot = (_slot + 1) % GOPRO_PREVIEW_SLOTS;
+
+    if (len > GOPRO_PREVIEW_PACKET_LEN)
+    {
+      _stats.truncated++;
+    }
+    const uint16_t used = _gp._keep_alive_client.read(packet, GOPRO_PREVIEW_PACKET_LEN);
+
+    const uint32_t now = millis();
+    if (_stats.packets > 0 && now - _last_packet > GOPRO_PREVIEW_LATE_MS)
+    {
+      _stats.late++;
+      // the counters may have gone round meanwhile, the holes are too old to be filled
+      for (uint8_t k = 0; k < _pid_count; k++)
+      {
+        _pids[k].missing = 0;
+      }
+    }
+    _last_packet = now;
+    _stats.packets++;
+    _stats.bytes += used;
+
+    check(packet, used);
+    if (_callback != nullptr)
+    {
+      _callback(_context, packet, used);
+    }
+  }
+
+  _gp.keepAlive();
+}
+
+void GoProPreview::resetStats()
+{
+  memset(&_stats, 0, sizeof(_stats));
+  _pid_count = 0;
+}
+
+void GoProPreview::check(const uint8_t *data, const uint16_t len)
+{
+  bool filled = false;
+
+  for (uint16_t i = 0; i + TS_PACKET_LEN <= len; i += TS_PACKET_LEN)
+  {
+    const uint8_t *ts = data + i;
+    if (ts[0] != TS_SYNC_BYTE)
+    {
+      continue;
+    }
+    const uint16_t pid = ((ts[1] & 0x1F) << 8) | ts[2];
+    if (pid == TS_NULL_PID || (ts[3] & 0x10) == 0)
+    {
+      continue; // the counter only moves on packets with a payload
+    }
+    Continuity *stream = continuity(pid);
+    if (stream == nullptr)
+    {
+      continue;
+    }
+
+    const uint8_t counter = ts[3] & 0x0F;
+    const uint8_t ahead = (counter - stream->last) & 0x0F; // 1 for the next packet
+    const uint16_t bit = 1 << (15 - ahead); // if it is 16 - ahead counters behind
+
+    if (stream->last == 0xFF)
+    {
+      stream->last = counter;
+    }
+    else if (ahead == 0)
+    {
+      continue; // the same counter twice is a duplicate
+    }
+    else if (ahead > 1 && (stream->missing & bit))
+    {
+      // a packet we gave up for lost
+      stream->missing &= ~bit;
+      _stats.dropped--;
+      filled = true;
+    }
+    else
+    {
+      // the holes age by the counters passed, at 16 they can't be told from
+      // the next lap and are forgotten
+      const uint8_t skipped = ahead - 1;
+      stream->missing = (stream->missing << ahead | ((1 << skipped) - 1)) & 0x7FFF;
+      stream->last = counter;
+      _stats.dropped += skipped;
+    }
+  }
+
+  if (filled)
+  {
+    _stats.out_of_order++;
+  }
+}
+
+GoProPreview::Continuity *GoProPreview::continuity(const uint16_t pid)
+{
+  for (uint8_t i = 0; i < _pid_count; i++)
+  {
+    if (_pids[i].pid == pid)
+    {
+      return &_pids[i];
+    }
+  }
+  if (_pid_count == PREVIEW_PIDS)
+  {
+    return nullptr;
+  }
+  _pids[_pid_count] = {pid, 0xFF, 0};
+  return &_pids[_pid_count++];
+}
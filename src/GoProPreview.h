@@ -0,0 +1,111 @@
+/*
+GoProPreview.h
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef GOPRO_PREVIEW_H
+#define GOPRO_PREVIEW_H
+
+#include <GoProControl.h>
+
+#define TS_PACKET_LEN 188
+
+// how many datagrams the ring holds, a packet given to the callback stays
+// valid until GOPRO_PREVIEW_SLOTS - 1 more packets arrived
+#if !defined(GOPRO_PREVIEW_SLOTS)
+#if defined(__AVR__)
+#define GOPRO_PREVIEW_SLOTS 1
+#else
+#define GOPRO_PREVIEW_SLOTS 4
+#endif
+#endif
+
+// the camera sends 7 transport stream packets in every datagram
+#if !defined(GOPRO_PREVIEW_PACKET_LEN)
+#define GOPRO_PREVIEW_PACKET_LEN (7 * TS_PACKET_LEN)
+#endif
+
+// a datagram which comes this many milliseconds after the previous one is late
+#if !defined(GOPRO_PREVIEW_LATE_MS)
+#define GOPRO_PREVIEW_LATE_MS 100
+#endif
+
+// how many streams (PID) of the transport stream are checked
+#define PREVIEW_PIDS 8
+
+// Called for every datagram, data points inside the ring: no copy is made
+typedef void (*GoProPacketCallback)(void *context, const uint8_t *data, uint16_t len);
+
+struct GoProPreviewStats
+{
+  uint32_t packets; // datagrams received
+  uint32_t bytes;
+  uint32_t dropped;      // transport stream packets which never arrived
+  uint32_t out_of_order; // datagrams which filled a hole left by the previous ones
+  uint32_t late;         // datagrams after a silence of GOPRO_PREVIEW_LATE_MS
+  uint32_t truncated;    // datagrams longer than GOPRO_PREVIEW_PACKET_LEN
+};
+
+// Live preview of a HERO4 and newer: begin() restarts the stream, poll() from
+// loop() receives the MPEG-TS datagrams of UDP port 8554 into a ring of
+// buffers, hands them to the callback and keeps the stream alive. The camera
+// streams to the port the keep-alives come from, so the socket is the one of
+// GoProControl::keepAlive(). The continuity counters of the transport stream
+// tell which packets were lost or came out of order: they have 4 bits, so a
+// hole of more than 15 packets of the same stream is counted short
+class GoProPreview
+{
+public:
+  // The camera must live as long as the preview, begin() it first
+  GoProPreview(GoProControl &camera) : _gp(camera) {}
+
+  uint8_t begin(GoProPacketCallback callback, void *context = nullptr);
+  void end();
+  void poll();
+  bool isStreaming() const { return _streaming; }
+
+  const GoProPreviewStats &stats() const { return _stats; }
+  void resetStats();
+
+private:
+  struct Continuity
+  {
+    uint16_t pid;
+    uint8_t last;     // counter of the last packet, 0xFF before the first one
+    uint16_t missing; // bit k: the packet k + 1 counters before last was skipped
+  };
+
+  GoProControl &_gp;
+  GoProPacketCallback _callback = nullptr;
+  void *_context = nullptr;
+  bool _streaming = false;
+
+  uint8_t _packets[GOPRO_PREVIEW_SLOTS][GOPRO_PREVIEW_PACKET_LEN];
+  uint8_t _slot = 0;
+  uint32_t _last_packet = 0; // millis() of the last datagram
+
+  Continuity _pids[PREVIEW_PIDS];
+  uint8_t _pid_count = 0;
+  GoProPreviewStats _stats;
+
+  void check(const uint8_t *data, const uint16_t len);
+  Continuity *continuity(const uint16_t pid);
+};
+
+#endif // GOPRO_PREVIEW_H
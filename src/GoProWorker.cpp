@@ -0,0 +1,346 @@
+/*
+GoProWorker.cpp
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+
+#include <GoProWorker.h>
+
+#if (defined(ARDUINO_ARCH_ESP32) || defined(GOPRO_HOST)) && GOPRO_ASYNC_SLOTS > 0
+
+uint8_t GoProWorker::begin()
+{
+  if (_running)
+  {
+    return true;
+  }
+  _running = true;
+  _stopped = false;
+#if defined(GOPRO_HOST)
+  _thread = std::thread(run, this);
+#elif GOPRO_NO_HEAP
+  // the stack and the task live in the worker
+  _task = xTaskCreateStaticPinnedToCore(run, "gopro_io", GOPRO_WORKER_STACK, this,
+                                        GOPRO_WORKER_PRIORITY, _stack, &_task_buffer,
+                                        GOPRO_WORKER_CORE);
+  if (_task == nullptr)
+  {
+    _running = false;
+    _stopped = true;
+    return false;
+  }
+#else
+  if (xTaskCreatePinnedToCore(run, "gopro_io", GOPRO_WORKER_STACK, this, GOPRO_WORKER_PRIORITY,
+                              &_task, GOPRO_WORKER_CORE) != pdPASS)
+  {
+    _running = false;
+    _stopped = true;
+    return false;
+  }
+#endif
+  return true;
+}
+
+void GoProWorker::end()
+{
+  _running = false;
+#if defined(GOPRO_HOST)
+  if (_thread.joinable())
+  {
+    _thread.join();
+  }
+#else
+  while (!_stopped)
+  {
+    delay(1);
+  }
+  _task = nullptr;
+#endif
+}
+
+uint8_t GoProWorker::poll()
+{
+  uint8_t count = 0;
+  Job job;
+  while (_done.pop(job))
+  {
+    _outstanding--; // before the callback, which may post again
+    if (job.callback != nullptr)
+    {
+      const GoProResult result = {job.handle, job.code, job.latency, nullptr, 0, job.expired};
+      job.callback(job.context, result);
+    }
+    count++;
+  }
+  return count;
+}
+
+void GoProWorker::cancel()
+{
+  _cancel = true; // only the I/O task touches the camera
+}
+
+uint8_t GoProWorker::connect(GoProCallback callback, void *context)
+{
+  return post(JOB_CONNECT, 0, 0, callback, context);
+}
+
+uint8_t GoProWorker::turnOn(GoProCallback callback, void *context)
+{
+  return post(JOB_TURN_ON, 0, 0, callback, context);
+}
+
+uint8_t GoProWorker::turnOff(GoProCallback callback, void *context, const bool force)
+{
+  return post(JOB_TURN_OFF, force, 0, callback, context);
+}
+
+uint8_t GoProWorker::shoot(GoProCallback callback, void *context)
+{
+  return post(JOB_SHOOT, 0, 0, callback, context);
+}
+
+uint8_t GoProWorker::stopShoot(GoProCallback callback, void *context)
+{
+  return post(JOB_STOP_SHOOT, 0, 0, callback, context);
+}
+
+uint8_t GoProWorker::setMode(const uint8_t option, GoProCallback callback, void *context)
+{
+  return post(JOB_MODE, option, 0, callback, context);
+}
+
+uint8_t GoProWorker::setOrientation(const uint8_t option, GoProCallback callback, void *context)
+{
+  return post(JOB_ORIENTATION, option, 0, callback, context);
+}
+
+uint8_t GoProWorker::setSetting(const uint8_t option, GoProCallback callback, void *context)
+{
+  return post(JOB_SETTING, option, 0, callback, context);
+}
+
+uint8_t GoProWorker::setTimeLapseInterval(float option, GoProCallback callback, void *context)
+{
+  return post(JOB_TIME_LAPSE, 0, option, callback, context);
+}
+
+uint8_t GoProWorker::localizationOn(GoProCallback callback, void *context)
+{
+  return post(JOB_LOCALIZATION_ON, 0, 0, callback, context);
+}
+
+uint8_t GoProWorker::localizationOff(GoProCallback callback, void *context)
+{
+  return post(JOB_LOCALIZATION_OFF, 0, 0, callback, context);
+}
+
+uint8_t GoProWorker::deleteLast(GoProCallback callback, void *context)
+{
+  return post(JOB_DELETE_LAST, 0, 0, callback, context);
+}
+
+uint8_t GoProWorker::deleteAll(GoProCallback callback, void *context)
+{
+  return post(JOB_DELETE_ALL, 0, 0, callback, context);
+}
+
+////////////////////////////////////////////////////////////
+////////                  Private                  /////////
+////////////////////////////////////////////////////////////
+
+uint8_t GoProWorker::post(const uint8_t kind, const uint8_t option, const float value,
+                          GoProCallback callback, void *context)
+{
+  if (!_running)
+  {
+    return 0;
+  }
+  // the bound keeps both mailboxes from filling up
+  if (_outstanding.fetch_add(1) >= GOPRO_WORKER_JOBS)
+  {
+    _outstanding--;
+    return 0;
+  }
+  uint8_t handle = ++_handle;
+  if (handle == 0)
+  {
+    handle = ++_handle; // 0 means that nothing was posted
+  }
+
+  const Job job = {handle, kind, option, 0, value, micros(), 0, DEADLINE_NONE,
+                   callback, context};
+  if (!_jobs.push(job))
+  {
+    _outstanding--;
+    return 0;
+  }
+  return handle;
+}
+
+void GoProWorker::run(void *worker)
+{
+  ((GoProWorker *)worker)->loop();
+#if !defined(GOPRO_HOST)
+  vTaskDelete(NULL);
+#endif
+}
+
+void GoProWorker::loop()
+{
+  while (_running)
+  {
+    // hand the new commands to the camera while its queue has room
+    for (;;)
+    {
+      if (!_holding && !_jobs.pop(_next))
+      {
+        break;
+      }
+      _holding = !send(_next);
+      if (_holding)
+      {
+        break;
+      }
+    }
+    if (_cancel)
+    {
+      _cancel = false;
+      _gp.cancel();
+    }
+    _gp.poll(); // the keep-alive too
+
+#if defined(GOPRO_HOST)
+    if (_gp.isBusy() || _holding)
+    {
+      yield();
+    }
+    else
+    {
+      delayMicroseconds(100);
+    }
+#else
+    delay(1); // the idle task of the core must run too
+#endif
+  }
+
+  // wait for the commands already sent, the others are given back unanswered
+  while (_gp.isBusy())
+  {
+    _gp.poll();
+    delay(1);
+  }
+  if (_holding)
+  {
+    finish(_next, 0);
+    _holding = false;
+  }
+  Job job;
+  while (_jobs.pop(job))
+  {
+    finish(job, 0);
+  }
+  _stopped = true;
+}
+
+bool GoProWorker::send(const Job &job)
+{
+  Flight *flight = nullptr;
+  for (uint8_t i = 0; i < GOPRO_ASYNC_SLOTS && flight == nullptr; i++)
+  {
+    if (!_flights[i].used)
+    {
+      flight = &_flights[i];
+    }
+  }
+  if (flight == nullptr)
+  {
+    return false;
+  }
+  *flight = {this, job, true};
+
+  uint8_t handle = 0;
+  switch (job.kind)
+  {
+  case JOB_CONNECT:
+    handle = _gp.beginAsync(onResult, flight);
+    break;
+  case JOB_TURN_ON:
+    handle = _gp.turnOnAsync(onResult, flight);
+    break;
+  case JOB_TURN_OFF:
+    handle = _gp.turnOffAsync(onResult, flight, job.option);
+    break;
+  case JOB_SHOOT:
+    handle = _gp.shootAsync(onResult, flight);
+    break;
+  case JOB_STOP_SHOOT:
+    handle = _gp.stopShootAsync(onResult, flight);
+    break;
+  case JOB_MODE:
+    handle = _gp.setModeAsync(job.option, onResult, flight);
+    break;
+  case JOB_ORIENTATION:
+    handle = _gp.setOrientationAsync(job.option, onResult, flight);
+    break;
+  case JOB_SETTING:
+    handle = _gp.setSettingAsync(job.option, onResult, flight);
+    break;
+  case JOB_TIME_LAPSE:
+    handle = _gp.setTimeLapseIntervalAsync(job.value, onResult, flight);
+    break;
+  case JOB_LOCALIZATION_ON:
+    handle = _gp.localizationOnAsync(onResult, flight);
+    break;
+  case JOB_LOCALIZATION_OFF:
+    handle = _gp.localizationOffAsync(onResult, flight);
+    break;
+  case JOB_DELETE_LAST:
+    handle = _gp.deleteLastAsync(onResult, flight);
+    break;
+  case JOB_DELETE_ALL:
+    handle = _gp.deleteAllAsync(onResult, flight);
+    break;
+  }
+
+  if (handle == 0) // refused by the camera: not connected, wrong option, ...
+  {
+    flight->used = false;
+    finish(job, 0);
+  }
+  return true;
+}
+
+void GoProWorker::finish(Job job, const uint16_t code, const uint8_t expired)
+{
+  job.code = code;
+  job.expired = expired;
+  job.latency = micros() - job.start;
+  _done.push(job); // always room, see post()
+}
+
+void GoProWorker::onResult(void *context, const GoProResult &result)
+{
+  Flight *flight = (Flight *)context;
+  flight->used = false;
+  flight->worker->finish(flight->job, result.code, result.expired);
+}
+
+#endif // (ARDUINO_ARCH_ESP32 || GOPRO_HOST) && GOPRO_ASYNC_SLOTS > 0
@@ -0,0 +1,172 @@
+/*
+GoProWorker.h
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#ifndef GOPRO_WORKER_H
+#define GOPRO_WORKER_H
+
+#include <GoProControl.h>
+
+// a task of its own is needed: ESP32 (FreeRTOS) and the host build. The
+// commands go through the asynchronous ring of GoProControl, without it
+// (GOPRO_LOW_RAM) there is no worker
+#if (defined(ARDUINO_ARCH_ESP32) || defined(GOPRO_HOST)) && GOPRO_ASYNC_SLOTS > 0
+
+#include <GoProMailbox.h>
+
+#if defined(GOPRO_HOST)
+#include <thread>
+#endif
+
+// commands posted and not yet given back by poll(), a power of two
+#if !defined(GOPRO_WORKER_JOBS)
+#define GOPRO_WORKER_JOBS 8
+#endif
+
+// the I/O task on the ESP32
+#if !defined(GOPRO_WORKER_CORE)
+#define GOPRO_WORKER_CORE 0
+#endif
+#define GOPRO_WORKER_STACK 8192 // bytes, part of the worker with GOPRO_NO_HEAP
+#define GOPRO_WORKER_PRIORITY 1
+
+// A task which owns the camera: it is the only one that touches the sockets and
+// the buffers of GoProControl, it sends the commands one after the other and
+// keeps the camera alive. Any task can post a command, they return at once
+// with a handle (0 if the mailbox is full), and poll() gives the results to
+// the callbacks in the task which calls it. Don't call the camera directly
+// while the worker runs
+class GoProWorker
+{
+public:
+  GoProWorker(GoProControl &camera) : _gp(camera) {}
+  ~GoProWorker() { end(); }
+
+  // Start and stop the I/O task, end() waits for the commands already sent
+  uint8_t begin();
+  void end();
+  bool isRunning() const { return _running; }
+
+  // Call the callbacks of the commands which are over, returns how many
+  uint8_t poll();
+  // Posted and not yet given back by poll()
+  uint8_t pending() const { return _outstanding; }
+  // Stop the command the camera is sending, see GoProControl::cancel(): the
+  // I/O task passes it on, the callback gets DEADLINE_CANCELLED
+  void cancel();
+
+  uint8_t connect(GoProCallback callback = nullptr, void *context = nullptr);
+  uint8_t turnOn(GoProCallback callback = nullptr, void *context = nullptr);
+  uint8_t turnOff(GoProCallback callback = nullptr, void *context = nullptr,
+                  const bool force = false);
+  uint8_t shoot(GoProCallback callback = nullptr, void *context = nullptr);
+  uint8_t stopShoot(GoProCallback callback = nullptr, void *context = nullptr);
+  uint8_t setMode(const uint8_t option, GoProCallback callback = nullptr,
+                  void *context = nullptr);
+  uint8_t setOrientation(const uint8_t option, GoProCallback callback = nullptr,
+                         void *context = nullptr);
+  // any option of Settings.h, as GoProControl::setSetting()
+  uint8_t setSetting(const uint8_t option, GoProCallback callback = nullptr,
+                     void *context = nullptr);
+  uint8_t setTimeLapseInterval(float option, GoProCallback callback = nullptr,
+                               void *context = nullptr);
+  uint8_t localizationOn(GoProCallback callback = nullptr, void *context = nullptr);
+  uint8_t localizationOff(GoProCallback callback = nullptr, void *context = nullptr);
+  uint8_t deleteLast(GoProCallback callback = nullptr, void *context = nullptr);
+  uint8_t deleteAll(GoProCallback callback = nullptr, void *context = nullptr);
+
+private:
+  enum JobKind : uint8_t
+  {
+    JOB_CONNECT,
+    JOB_TURN_ON,
+    JOB_TURN_OFF,
+    JOB_SHOOT,
+    JOB_STOP_SHOOT,
+    JOB_MODE,
+    JOB_ORIENTATION,
+    JOB_SETTING,
+    JOB_TIME_LAPSE,
+    JOB_LOCALIZATION_ON,
+    JOB_LOCALIZATION_OFF,
+    JOB_DELETE_LAST,
+    JOB_DELETE_ALL
+  };
+
+  // a command on its way, from the posting task to the I/O task and back
+  struct Job
+  {
+    uint8_t handle;
+    uint8_t kind;
+    uint8_t option;
+    uint16_t code;
+    float value;
+    uint32_t start; // micros() of the post
+    uint32_t latency;
+    uint8_t expired; // gopro_deadline
+    GoProCallback callback;
+    void *context;
+  };
+
+  // a command given to the asynchronous queue of the camera
+  struct Flight
+  {
+    GoProWorker *worker;
+    Job job;
+    bool used;
+  };
+
+  GoProControl &_gp;
+  GoProMailbox<Job, GOPRO_WORKER_JOBS> _jobs;
+  GoProMailbox<Job, GOPRO_WORKER_JOBS> _done;
+  std::atomic<uint8_t> _outstanding{0};
+  std::atomic<uint8_t> _handle{0};
+  std::atomic<bool> _running{false};
+  std::atomic<bool> _stopped{true};
+  std::atomic<bool> _cancel{false}; // for the I/O task
+
+  // owned by the I/O task
+  Flight _flights[GOPRO_ASYNC_SLOTS] = {};
+  Job _next; // popped, waiting for room in the queue of the camera
+  bool _holding = false;
+
+#if defined(GOPRO_HOST)
+  std::thread _thread;
+#else
+  TaskHandle_t _task = nullptr;
+#if GOPRO_NO_HEAP
+  StackType_t _stack[GOPRO_WORKER_STACK];
+  StaticTask_t _task_buffer;
+#endif
+#endif
+
+  uint8_t post(const uint8_t kind, const uint8_t option, const float value,
+               GoProCallback callback, void *context);
+  static void run(void *worker);
+  void loop();
+  bool send(const Job &job);
+  void finish(Job job, const uint16_t code, const uint8_t expired = DEADLINE_NONE);
+  static void onResult(void *context, const GoProResult &result);
+};
+
+#endif // (ARDUINO_ARCH_ESP32 || GOPRO_HOST) && GOPRO_ASYNC_SLOTS > 0
+
+#endif // GOPRO_WORKER_H
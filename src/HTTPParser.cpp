@@ -0,0 +1,279 @@
+/*
+HTTPParser.cpp
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <HTTPParser.h>
+#include <errno.h>
+
+void HTTPParser::reset(HTTPBodyCallback sink, void *context)
+{
+  _state = STATUS_LINE;
+  _line_len = 0;
+  _code = 0;
+  _content_length = 0;
+  _has_length = false;
+  _range_total = 0;
+  _chunked = false;
+  _keep_alive = true;
+  _chunk_extension = false;
+  _remaining = 0;
+  _body_len = 0;
+  _sink = sink;
+  _context = context;
+}
+
+uint16_t HTTPParser::parse(const char *data, uint16_t len)
+{
+  uint16_t i = 0;
+
+  while (i < len && !isDone())
+  {
+    switch (_state)
+    {
+    case STATUS_LINE:
+      if (appendLine(data[i++]))
+      {
+        parseStatusLine();
+      }
+      break;
+
+    case HEADER_LINE:
+      if (appendLine(data[i++]))
+      {
+        if (_line_len == 0) // empty line: end of the headers
+        {
+          startBody();
+        }
+        else
+        {
+          parseHeaderLine();
+        }
+      }
+      break;
+
+    case BODY:
+    case CHUNK_DATA:
+    {
+      uint16_t run = len - i;
+      if (run > _remaining)
+      {
+        run = _remaining;
+      }
+      deliver(data + i, run);
+      i += run;
+      _remaining -= run;
+      if (_remaining == 0)
+      {
+        _state = _state == BODY ? COMPLETE : CHUNK_DATA_END;
+      }
+      break;
+    }
+
+    case BODY_UNTIL_CLOSE:
+      deliver(data + i, len - i);
+      i = len;
+      break;
+
+    case CHUNK_SIZE:
+    {
+      const char c = data[i++];
+      if (c == '\n')
+      {
+        _chunk_extension = false;
+        _state = _remaining == 0 ? CHUNK_TRAILER : CHUNK_DATA;
+      }
+      else if (c == ';')
+      {
+        _chunk_extension = true;
+      }
+      else if (!_chunk_extension && c != '\r')
+      {
+        int8_t digit = -1;
+        if (c >= '0' && c <= '9')
+        {
+          digit = c - '0';
+        }
+        else if (c >= 'a' && c <= 'f')
+        {
+          digit = c - 'a' + 10;
+        }
+        else if (c >= 'A' && c <= 'F')
+        {
+          digit = c - 'A' + 10;
+        }
+        if (digit == -1)
+        {
+          _state = FAILED;
+        }
+        else
+        {
+          _remaining = (_remaining << 4) | digit;
+        }
+      }
+      break;
+    }
+
+    case CHUNK_DATA_END:
+      if (data[i++] == '\n')
+      {
+        _state = CHUNK_SIZE;
+      }
+      break;
+
+    case CHUNK_TRAILER:
+      if (appendLine(data[i++]))
+      {
+        if (_line_len == 0)
+        {
+          _state = COMPLETE;
+        }
+        _line_len = 0;
+      }
+      break;
+
+    default:
+      break;
+    }
+  }
+  return i;
+}
+
+void HTTPParser::finish()
+{
+  if (_state == BODY_UNTIL_CLOSE)
+  {
+    _state = COMPLETE;
+  }
+  else if (_state != COMPLETE)
+  {
+    _state = FAILED;
+  }
+}
+
+bool HTTPParser::appendLine(const char c)
+{
+  if (c == '\n')
+  {
+    _line[_line_len] = '\0';
+    return true;
+  }
+  // the lines we need are short, the tail of a long one can be dropped
+  if (c != '\r' && _line_len < HTTP_LINE_LEN - 1)
+  {
+    _line[_line_len++] = c;
+  }
+  return false;
+}
+
+void HTTPParser::parseStatusLine()
+{
+  // HTTP/1.1 200 OK
+  if (strncmp(_line, "HTTP/1.", 7) != 0)
+  {
+    _state = FAILED;
+    return;
+  }
+  _keep_alive = _line[7] != '0';
+  const char *code = strchr(_line, ' ');
+  _code = code != nullptr ? atoi(code + 1) : 0;
+  _line_len = 0;
+  _state = _code == 0 ? FAILED : HEADER_LINE;
+}
+
+void HTTPParser::parseHeaderLine()
+{
+  char *colon = strchr(_line, ':');
+  if (colon != nullptr)
+  {
+    const uint8_t name_len = colon - _line;
+    const char *value = colon + 1;
+    while (*value == ' ')
+    {
+      value++;
+    }
+
+    if (name_len == 14 && strncasecmp(_line, "Content-Length", 14) == 0)
+    {
+      // videos go past 2 GB, a length that doesn't fit 32 bits can't be followed
+      char *end;
+      errno = 0;
+      const unsigned long length = strtoul(value, &end, 10);
+      if (end == value || *value == '-' || errno == ERANGE || length > 0xFFFFFFFFUL)
+      {
+        _state = FAILED;
+        return;
+      }
+      _content_length = length;
+      _has_length = true;
+    }
+    else if (name_len == 13 && strncasecmp(_line, "Content-Range", 13) == 0)
+    {
+      // bytes 0-1023/146515
+      const char *total = strchr(value, '/');
+      _range_total = total != nullptr ? strtoul(total + 1, nullptr, 10) : 0;
+    }
+    else if (name_len == 17 && strncasecmp(_line, "Transfer-Encoding", 17) == 0)
+    {
+      _chunked = strncasecmp(value, "chunked", 7) == 0;
+    }
+    else if (name_len == 10 && strncasecmp(_line, "Connection", 10) == 0)
+    {
+      _keep_alive = strncasecmp(value, "close", 5) != 0;
+    }
+  }
+  _line_len = 0;
+}
+
+void HTTPParser::startBody()
+{
+  _line_len = 0;
+  if (_code < 200 || _code == 204 || _code == 304)
+  {
+    _state = COMPLETE;
+  }
+  else if (_chunked)
+  {
+    _remaining = 0;
+    _state = CHUNK_SIZE;
+  }
+  else if (_has_length)
+  {
+    _remaining = _content_length;
+    _state = _remaining == 0 ? COMPLETE : BODY;
+  }
+  else
+  {
+    _keep_alive = false; // the end of the body is the end of the connection
+    _state = BODY_UNTIL_CLOSE;
+  }
+}
+
+void HTTPParser::deliver(const char *data, uint16_t len)
+{
+  if (len == 0)
+  {
+    return;
+  }
+  _body_len += len;
+  if (_sink != nullptr)
+  {
+    _sink(_context, data, len);
+  }
+}
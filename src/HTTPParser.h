@@ -0,0 +1,104 @@
+/*
+HTTPParser.h
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef GOPRO_HTTP_PARSER_H
+#define GOPRO_HTTP_PARSER_H
+
+#include <Arduino.h>
+
+// longer status and header lines are cut, what we look for is at the start
+#if GOPRO_LOW_RAM
+#define HTTP_LINE_LEN 40
+#else
+#define HTTP_LINE_LEN 64
+#endif
+
+// Called for every run of body bytes, already stripped of the chunked framing
+typedef void (*HTTPBodyCallback)(void *context, const char *data, uint16_t len);
+
+// Incremental parser of an HTTP/1.x response: feed it the bytes as they come
+// from the socket, it tracks the status line, the headers we care about
+// (Content-Length, Content-Range, Transfer-Encoding, Connection) and the body
+// framing, and it knows the exact moment the response is over
+class HTTPParser
+{
+public:
+  void reset(HTTPBodyCallback sink = nullptr, void *context = nullptr);
+
+  // Returns the number of bytes used, it stops at the end of the response
+  uint16_t parse(const char *data, uint16_t len);
+  // The connection was closed by the camera
+  void finish();
+
+  bool isComplete() const { return _state == COMPLETE; }
+  bool isFailed() const { return _state == FAILED; }
+  bool isDone() const { return _state == COMPLETE || _state == FAILED; }
+  bool headersDone() const { return _state > HEADER_LINE; }
+
+  uint16_t statusCode() const { return _code; }
+  bool hasContentLength() const { return _has_length; }
+  uint32_t contentLength() const { return _content_length; }
+  // Size of the whole resource of a 206 answer, 0 if unknown
+  uint32_t rangeTotal() const { return _range_total; }
+  bool isChunked() const { return _chunked; }
+  bool keepAlive() const { return _keep_alive; }
+  uint32_t bodyLength() const { return _body_len; }
+
+private:
+  enum State : uint8_t
+  {
+    STATUS_LINE,
+    HEADER_LINE,
+    BODY,
+    BODY_UNTIL_CLOSE,
+    CHUNK_SIZE,
+    CHUNK_DATA,
+    CHUNK_DATA_END,
+    CHUNK_TRAILER,
+    COMPLETE,
+    FAILED
+  };
+
+  State _state = STATUS_LINE;
+  char _line[HTTP_LINE_LEN];
+  uint8_t _line_len = 0;
+
+  uint16_t _code = 0;
+  uint32_t _content_length = 0;
+  bool _has_length = false;
+  uint32_t _range_total = 0;
+  bool _chunked = false;
+  bool _keep_alive = true;
+  bool _chunk_extension = false;
+  uint32_t _remaining = 0;
+  uint32_t _body_len = 0;
+
+  HTTPBodyCallback _sink = nullptr;
+  void *_context = nullptr;
+
+  bool appendLine(const char c);
+  void parseStatusLine();
+  void parseHeaderLine();
+  void startBody();
+  void deliver(const char *data, uint16_t len);
+};
+
+#endif // GOPRO_HTTP_PARSER_H
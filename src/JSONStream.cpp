@@ -0,0 +1,184 @@
+/*
+JSONStream.cpp
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include <JSONStream.h>
+
+void JSONStream::resetStream()
+{
+  _state = JSON_VALUE;
+  _depth = 0;
+  _arrays = 0;
+  _expect_key = false;
+  _is_key = false;
+  _complete = false;
+  _token_len = 0;
+  _key[0] = '\0';
+}
+
+void JSONStream::feed(void *context, const char *data, uint16_t len)
+{
+  ((JSONStream *)context)->parse(data, len);
+}
+
+void JSONStream::parse(const char *data, uint16_t len)
+{
+  for (uint16_t i = 0; i < len && _state != JSON_FAILED && !_complete; i++)
+  {
+    const char c = data[i];
+    switch (_state)
+    {
+    case JSON_STRING:
+      if (c == '"')
+      {
+        _token[_token_len] = '\0';
+        _state = JSON_VALUE;
+        if (_is_key)
+        {
+          strncpy(_key, _token, JSON_KEY_LEN - 1);
+          _key[JSON_KEY_LEN - 1] = '\0';
+          _expect_key = false;
+        }
+        else
+        {
+          onValue(_depth, _key, _token);
+        }
+      }
+      else if (c == '\\')
+      {
+        _state = JSON_ESCAPE;
+      }
+      else
+      {
+        append(c);
+      }
+      break;
+
+    case JSON_ESCAPE:
+      // the camera sends plain ASCII, an escaped char is kept as it is
+      append(c);
+      _state = JSON_STRING;
+      break;
+
+    case JSON_LITERAL:
+      if (c != ',' && c != '}' && c != ']' && c != ' ' && c != '\r' && c != '\n' && c != '\t')
+      {
+        append(c);
+        break;
+      }
+      _token[_token_len] = '\0';
+      _state = JSON_VALUE;
+      onValue(_depth, _key, _token);
+      structural(c); // the char which ended the number
+      break;
+
+    case JSON_VALUE:
+      structural(c);
+      break;
+
+    default:
+      break;
+    }
+  }
+}
+
+void JSONStream::append(const char c)
+{
+  // the values we need are short, the tail of a long one can be dropped
+  if (_token_len < JSON_TOKEN_LEN - 1)
+  {
+    _token[_token_len++] = c;
+  }
+}
+
+void JSONStream::structural(const char c)
+{
+  switch (c)
+  {
+  case '{':
+    open(false);
+    break;
+  case '[':
+    open(true);
+    break;
+  case '}':
+  case ']':
+    if (_depth == 0 || isArray(_depth) != (c == ']'))
+    {
+      _state = JSON_FAILED;
+      return;
+    }
+    close();
+    break;
+  case ',':
+    _expect_key = _depth > 0 && !isArray(_depth);
+    break;
+  case ':':
+    _expect_key = false;
+    break;
+  case '"':
+    _is_key = _expect_key;
+    _token_len = 0;
+    _state = JSON_STRING;
+    break;
+  case ' ':
+  case '\r':
+  case '\n':
+  case '\t':
+    break;
+  default: // number, true, false or null
+    _token[0] = c;
+    _token_len = 1;
+    _state = JSON_LITERAL;
+    break;
+  }
+}
+
+void JSONStream::open(const bool array)
+{
+  if (_depth == 31)
+  {
+    _state = JSON_FAILED;
+    return;
+  }
+  _depth++;
+  if (array)
+  {
+    _arrays |= 1UL << _depth;
+  }
+  else
+  {
+    _arrays &= ~(1UL << _depth);
+  }
+  _expect_key = !array;
+  onOpen(_depth, array, _key);
+}
+
+void JSONStream::close()
+{
+  onClose(_depth, isArray(_depth));
+  _depth--;
+  _expect_key = false;
+  if (_depth == 0)
+  {
+    _complete = true;
+  }
+}
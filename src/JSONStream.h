@@ -0,0 +1,81 @@
+/*
+JSONStream.h
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#ifndef GOPRO_JSON_STREAM_H
+#define GOPRO_JSON_STREAM_H
+
+#include <Arduino.h>
+
+#define JSON_TOKEN_LEN 24 // longer strings and numbers are cut
+#define JSON_KEY_LEN 12
+
+// Event based JSON reader for the answers of the camera: it reads one byte at
+// a time and keeps only the token being read, the subclass picks what it needs
+// from the events
+class JSONStream
+{
+public:
+  void parse(const char *data, uint16_t len);
+  // HTTPBodyCallback which feeds the stream given as context
+  static void feed(void *context, const char *data, uint16_t len);
+
+  bool isComplete() const { return _complete; }
+  bool isFailed() const { return _state == JSON_FAILED; }
+
+protected:
+  void resetStream();
+
+  // The root object is at depth 1, key is the one of the container or of the
+  // value, inside an array it is the key of the array
+  virtual void onOpen(const uint8_t depth, const bool array, const char *key) = 0;
+  virtual void onClose(const uint8_t depth, const bool array) = 0;
+  virtual void onValue(const uint8_t depth, const char *key, const char *value) = 0;
+
+private:
+  enum State : uint8_t
+  {
+    JSON_VALUE,
+    JSON_STRING,
+    JSON_ESCAPE,
+    JSON_LITERAL,
+    JSON_FAILED
+  };
+
+  State _state = JSON_VALUE;
+  uint8_t _depth = 0;
+  uint32_t _arrays = 0; // bit n is set if the container at depth n is an array
+  bool _expect_key = false;
+  bool _is_key = false;
+  bool _complete = false;
+
+  char _token[JSON_TOKEN_LEN];
+  uint8_t _token_len = 0;
+  char _key[JSON_KEY_LEN];
+
+  void append(const char c);
+  void structural(const char c);
+  void open(const bool array);
+  void close();
+  bool isArray(const uint8_t depth) const { return _arrays & (1UL << depth); }
+};
+
+#endif // GOPRO_JSON_STREAM_H
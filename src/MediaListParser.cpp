@@ -0,0 +1,164 @@
+/*
+MediaListParser.cpp
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include <MediaListParser.h>
+
+// {"id":"...","media":[{"d":"100GOPRO","fs":[{"n":"GOPR0001.JPG","cre":"...",
+// "mod":"...","s":"..."},{"n":"G0010002.JPG","g":"1","b":"2","l":"31","m":[],
+// "t":"b",...}]}]}
+#define DEPTH_MEDIA 2     // the array of directories
+#define DEPTH_DIRECTORY 3 // {"d":...,"fs":[...]}
+#define DEPTH_FILES 4     // the array of files
+#define DEPTH_FILE 5      // {"n":...}
+#define DEPTH_MISSING 6   // "m":[...] of a group
+
+void MediaListParser::reset(GoProFileCallback on_file, void *context,
+                            const GoProMediaFilter *filter, GoProDirectoryCallback on_directory)
+{
+  resetStream();
+  _in_media = false;
+  _in_files = false;
+  _directory[0] = '\0';
+  _name[0] = '\0';
+  _files = 0;
+  _matched = 0;
+  _filter = filter;
+  _on_directory = on_directory;
+  _on_file = on_file;
+  _context = context;
+}
+
+void MediaListParser::onOpen(const uint8_t depth, const bool array, const char *key)
+{
+  if (depth == DEPTH_MEDIA)
+  {
+    _in_media = array && strcmp(key, "media") == 0;
+  }
+  else if (depth == DEPTH_DIRECTORY && _in_media)
+  {
+    _directory[0] = '\0';
+  }
+  else if (depth == DEPTH_FILES)
+  {
+    _in_files = _in_media && array && strcmp(key, "fs") == 0;
+  }
+  else if (depth == DEPTH_FILE && _in_files && !array)
+  {
+    memset(&_file, 0, sizeof(_file));
+    _name[0] = '\0';
+  }
+}
+
+void MediaListParser::onClose(const uint8_t depth, const bool array)
+{
+  if (depth == DEPTH_FILE && _in_files && !array)
+  {
+    endFile();
+  }
+  else if (depth == DEPTH_FILES)
+  {
+    _in_files = false;
+  }
+  else if (depth == DEPTH_MEDIA)
+  {
+    _in_media = false;
+  }
+}
+
+void MediaListParser::onValue(const uint8_t depth, const char *key, const char *value)
+{
+  if (depth == DEPTH_DIRECTORY && _in_media && strcmp(key, "d") == 0)
+  {
+    strncpy(_directory, value, MEDIA_NAME_LEN - 1);
+    _directory[MEDIA_NAME_LEN - 1] = '\0';
+    if (_on_directory != nullptr)
+    {
+      _on_directory(_context, _directory);
+    }
+  }
+  else if (depth == DEPTH_FILE && _in_files)
+  {
+    if (strcmp(key, "n") == 0)
+    {
+      strncpy(_name, value, MEDIA_NAME_LEN - 1);
+      _name[MEDIA_NAME_LEN - 1] = '\0';
+    }
+    else if (strcmp(key, "s") == 0)
+    {
+      _file.size = strtoul(value, nullptr, 10);
+    }
+    else if (strcmp(key, "cre") == 0)
+    {
+      _file.created = strtoul(value, nullptr, 10);
+    }
+    else if (strcmp(key, "mod") == 0)
+    {
+      _file.modified = strtoul(value, nullptr, 10);
+    }
+    else if (strcmp(key, "g") == 0)
+    {
+      _file.group = atoi(value);
+    }
+    else if (strcmp(key, "b") == 0)
+    {
+      _file.first = atoi(value);
+    }
+    else if (strcmp(key, "l") == 0)
+    {
+      _file.last = atoi(value);
+    }
+    else if (strcmp(key, "t") == 0)
+    {
+      _file.group_type = value[0];
+    }
+  }
+  else if (depth == DEPTH_MISSING && _in_files && strcmp(key, "m") == 0)
+  {
+    _file.missing++;
+  }
+}
+
+void MediaListParser::endFile()
+{
+  _files++;
+
+  const char *extension = strrchr(_name, '.');
+  _file.type = extension != nullptr && strcasecmp(extension, ".MP4") == 0 ? MEDIA_VIDEO
+                                                                          : MEDIA_PHOTO;
+  _file.directory = _directory;
+  _file.name = _name;
+
+  if (_filter != nullptr)
+  {
+    // a file without a creation time still passes newer_than 0
+    if ((_filter->types & _file.type) == 0 ||
+        (_filter->newer_than != 0 && _file.created <= _filter->newer_than))
+    {
+      return;
+    }
+  }
+  _matched++;
+  if (_on_file != nullptr)
+  {
+    _on_file(_context, _file);
+  }
+}
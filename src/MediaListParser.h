@@ -0,0 +1,102 @@
+/*
+MediaListParser.h
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#ifndef GOPRO_MEDIA_LIST_PARSER_H
+#define GOPRO_MEDIA_LIST_PARSER_H
+
+#include <JSONStream.h>
+
+#define MEDIA_NAME_LEN 16 // "GOPR0001.MP4", "100GOPRO"
+
+enum GoProMediaType : uint8_t
+{
+  MEDIA_PHOTO = 1,
+  MEDIA_VIDEO = 2,
+  MEDIA_ALL = MEDIA_PHOTO | MEDIA_VIDEO,
+};
+
+// One entry of /gp/gpMediaList, the strings are valid only inside the callback
+struct GoProMediaFile
+{
+  const char *directory; // "100GOPRO"
+  const char *name;      // "GOPR0001.MP4"
+  uint8_t type;          // MEDIA_PHOTO or MEDIA_VIDEO
+  uint32_t size;         // bytes
+  uint32_t created;      // unix time
+  uint32_t modified;     // unix time
+
+  // a burst or a time-lapse is a single entry for many files
+  char group_type;       // 'b' burst, 't' time-lapse, 'n' night-lapse, 'c' continuous, 0 not a group
+  uint16_t group;        // id of the group
+  uint16_t first;        // number of the first file of the group
+  uint16_t last;         // number of the last file of the group
+  uint16_t missing;      // files of the group which were deleted
+};
+
+// Only the files which match are given to the callback
+struct GoProMediaFilter
+{
+  uint8_t types;       // MEDIA_PHOTO, MEDIA_VIDEO or MEDIA_ALL
+  uint32_t newer_than; // unix time, only the files created after it, 0 for all
+};
+
+typedef void (*GoProDirectoryCallback)(void *context, const char *directory);
+typedef void (*GoProFileCallback)(void *context, const GoProMediaFile &file);
+
+// Streaming parser of the JSON media list: it keeps only the entry being
+// parsed, so the list can be of any size
+class MediaListParser : public JSONStream
+{
+public:
+  void reset(GoProFileCallback on_file,
+             void *context,
+             const GoProMediaFilter *filter = nullptr,
+             GoProDirectoryCallback on_directory = nullptr);
+
+  uint16_t files() const { return _files; }     // entries in the list
+  uint16_t matched() const { return _matched; } // entries given to the callback
+
+protected:
+  void onOpen(const uint8_t depth, const bool array, const char *key) override;
+  void onClose(const uint8_t depth, const bool array) override;
+  void onValue(const uint8_t depth, const char *key, const char *value) override;
+
+private:
+  bool _in_media = false;
+  bool _in_files = false;
+
+  char _directory[MEDIA_NAME_LEN];
+  char _name[MEDIA_NAME_LEN];
+  GoProMediaFile _file;
+
+  uint16_t _files = 0;
+  uint16_t _matched = 0;
+
+  const GoProMediaFilter *_filter = nullptr;
+  GoProDirectoryCallback _on_directory = nullptr;
+  GoProFileCallback _on_file = nullptr;
+  void *_context = nullptr;
+
+  void endFile();
+};
+
+#endif // GOPRO_MEDIA_LIST_PARSER_H
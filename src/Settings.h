@@ -19,6 +19,9 @@ IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
 CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 */
 
+#ifndef GOPRO_SETTINGS_H
+#define GOPRO_SETTINGS_H
+
 #define KEEP_ALIVE 2500
 #define MAX_WAIT_TIME 2000
 
@@ -145,6 +148,24 @@ enum photo_resolution
   photo_resolution_last
 };
 
+// The settings which the library can change, GoProStatus has the current
+// option of each one
+enum setting_kind : uint8_t
+{
+  SETTING_MODE,
+  SETTING_ORIENTATION,
+  SETTING_VIDEO_RESOLUTION,
+  SETTING_VIDEO_FOV,
+  SETTING_FRAME_RATE,
+  SETTING_VIDEO_ENCODING,
+  SETTING_PHOTO_RESOLUTION,
+  SETTING_TIME_LAPSE,
+  SETTING_CONTINUOUS_SHOT,
+  setting_kinds
+};
+
+#define NO_CODE 0xFF // unknown or not supported
+
 #if defined(ARDUINO_ARCH_ESP32)
 const uint8_t BLE_WiFiOn[] = {17, 01, 01};
 const uint8_t BLE_WiFiOff[] = {17, 01, 00};
@@ -154,3 +175,5 @@ const uint8_t BLE_ModeVideo[] = {02, 01, 00};
 const uint8_t BLE_ModePhoto[] = {02, 01, 01};
 const uint8_t BLE_ModeMultiShot[] = {02, 01, 02};
 #endif
+
+#endif // GOPRO_SETTINGS_H
@@ -0,0 +1,216 @@
+/*
+SettingsTable.h
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#ifndef GOPRO_SETTINGS_TABLE_H
+#define GOPRO_SETTINGS_TABLE_H
+
+#include <Arduino.h>
+#include <Settings.h>
+
+// Every setting is a row of settings_table: the option is turned into an index
+// (its distance from the *_first member of its enum) and the index into the
+// code the camera wants. Supporting a new camera means adding it to
+// camera_generation and, if it talks differently, a column to the tables
+
+// The tables are in flash on AVR, where a 2 kB board can't spare the RAM: read
+// them with readSettingTable() and settingByte()
+#if defined(__AVR__)
+#define SETTINGS_PROGMEM PROGMEM
+#else
+#define SETTINGS_PROGMEM
+#endif
+
+// HERO4 and newer modes: the low nibble is the mode, the high one is the sub
+// mode + 1, 0 if the command has no sub mode
+#define SUB_MODE(mode, sub_mode) (((sub_mode) + 1) << 4 | (mode))
+
+enum generation : uint8_t
+{
+  GEN_HERO3, // /camera/<command>?t=<password>&p=%<hex code>
+  GEN_HERO4, // /gp/gpControl/setting/<id>/<code>
+  GEN_HERO8, // as HERO4, some settings moved to a new id
+  generations,
+  NO_GENERATION = 0xFF
+};
+
+constexpr uint8_t camera_generation[] SETTINGS_PROGMEM = {
+    NO_GENERATION, // 0
+    NO_GENERATION, // HERO
+    NO_GENERATION, // HERO2
+    GEN_HERO3,     // HERO3
+    GEN_HERO4,     // HERO4
+    GEN_HERO4,     // HERO5
+    GEN_HERO4,     // HERO6
+    GEN_HERO4,     // HERO7
+    GEN_HERO4,     // FUSION
+    GEN_HERO8,     // HERO8
+    GEN_HERO8,     // MAX
+};
+static_assert(sizeof(camera_generation) == MAX + 1, "a camera is missing a generation");
+
+struct SettingTable
+{
+  uint8_t first;                     // the *_first member of the enum
+  uint8_t count;                     // options of the setting
+  const uint8_t *values;             // the options if they aren't enum members, nullptr otherwise
+  const char *command;               // HERO3 command, in flash on AVR
+  uint8_t id[generations];           // HERO4 and newer setting id
+  const uint8_t *codes[generations]; // code of every option, NO_CODE if not supported
+};
+
+// every table has a code for each option of its enum
+#define CHECK_CODES(codes, setting) \
+  static_assert(sizeof(codes) == setting##_last - setting##_first - 1, #codes " has a wrong size")
+
+#define X NO_CODE
+
+// VIDEO, VIDEO_SUB, VIDEO_PHOTO, VIDEO_TIMELAPSE, VIDEO_LOOPING, VIDEO_TIMEWARP,
+// PHOTO, PHOTO_SINGLE, PHOTO_NIGHT, MULTISHOT, MULTISHOT_BURST,
+// MULTISHOT_TIMELAPSE, MULTISHOT_NIGHTLAPSE, BURST, TIMELAPSE, TIMER, PLAY_HDMI
+constexpr uint8_t mode_hero3[] SETTINGS_PROGMEM = {0x00, X, X, X, X, X, 0x01, X, X,
+                                                   X, X, X, X, 0x02, 0x03, 0x04, 0x05};
+constexpr uint8_t mode_hero4[] SETTINGS_PROGMEM = {0, SUB_MODE(0, 0), SUB_MODE(0, 2),
+                                                   SUB_MODE(0, 1), SUB_MODE(0, 3),
+                                                   SUB_MODE(0, 4), 1, SUB_MODE(1, 1),
+                                                   SUB_MODE(1, 2), 2, SUB_MODE(2, 0),
+                                                   SUB_MODE(2, 1), SUB_MODE(2, 2), X, X, X, X};
+constexpr char mode_command[] SETTINGS_PROGMEM = "CM";
+CHECK_CODES(mode_hero3, mode);
+CHECK_CODES(mode_hero4, mode);
+
+// UP, DOWN, AUTO
+constexpr uint8_t orientation_hero3[] SETTINGS_PROGMEM = {0x00, 0x01, X};
+constexpr uint8_t orientation_hero4[] SETTINGS_PROGMEM = {0, 1, 2};
+constexpr char orientation_command[] SETTINGS_PROGMEM = "UP";
+CHECK_CODES(orientation_hero3, orientation);
+CHECK_CODES(orientation_hero4, orientation);
+
+// 5.6K, 4K, 2K, 2K SuperView, 1440p, 1080p SuperView, 1080p, 960p,
+// 720p SuperView, 720p, WVGA
+constexpr uint8_t video_resolution_hero3[] SETTINGS_PROGMEM = {X, X,    X,    X, X,   X,
+                                                               0x06, 0x05, X, 0x03, 0x01};
+constexpr uint8_t video_resolution_hero4[] SETTINGS_PROGMEM = {21, 1,  4,  5,  7, 8,
+                                                               9,  10, 11, 12, 13};
+constexpr char video_resolution_command[] SETTINGS_PROGMEM = "VR";
+CHECK_CODES(video_resolution_hero3, video_resolution);
+CHECK_CODES(video_resolution_hero4, video_resolution);
+
+// DUAL360, WIDE, MEDIUM, NARROW, LINEAR
+constexpr uint8_t video_fov_hero3[] SETTINGS_PROGMEM = {X, 0x00, 0x01, 0x02, X};
+constexpr uint8_t video_fov_hero4[] SETTINGS_PROGMEM = {X, 0, 1, 2, 4};
+constexpr uint8_t video_fov_hero8[] SETTINGS_PROGMEM = {5, 0, 1, 6, 4};
+constexpr char video_fov_command[] SETTINGS_PROGMEM = "FV";
+CHECK_CODES(video_fov_hero3, video_fov);
+CHECK_CODES(video_fov_hero4, video_fov);
+CHECK_CODES(video_fov_hero8, video_fov);
+
+// 240, 120, 100, 90, 80, 60, 50, 48, 30, 25, 24, 15, 12.5, 12
+constexpr uint8_t frame_rate_hero3[] SETTINGS_PROGMEM = {0x0a, 0x09, 0x08, X,    X,    0x07, 0x06,
+                                                         0x05, 0x04, 0x03, 0x02, 0x01, 0x0b, 0x00};
+constexpr uint8_t frame_rate_hero4[] SETTINGS_PROGMEM = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, X, X, X, X};
+constexpr char frame_rate_command[] SETTINGS_PROGMEM = "FS";
+CHECK_CODES(frame_rate_hero3, frame_rate);
+CHECK_CODES(frame_rate_hero4, frame_rate);
+
+// NTSC, PAL
+constexpr uint8_t video_encoding_codes[] SETTINGS_PROGMEM = {0, 1};
+constexpr char video_encoding_command[] SETTINGS_PROGMEM = "VM";
+CHECK_CODES(video_encoding_codes, video_encoding);
+
+// 12MP WIDE, 12MP MEDIUM, 12MP NARROW, 12MP LINEAR, 11MP WIDE, 8MP WIDE,
+// 8MP MEDIUM, 7MP WIDE, 7MP MEDIUM, 5MP WIDE, 5MP MEDIUM
+constexpr uint8_t photo_resolution_hero3[] SETTINGS_PROGMEM = {X, X, X, X,    0x00, 0x01,
+                                                               X, X, X, 0x02, X};
+constexpr uint8_t photo_resolution_hero4[] SETTINGS_PROGMEM = {0, 8, 9, 10, X, X,
+                                                               X, 1, 2, 3,  X};
+constexpr char photo_resolution_command[] SETTINGS_PROGMEM = "PR";
+CHECK_CODES(photo_resolution_hero3, photo_resolution);
+CHECK_CODES(photo_resolution_hero4, photo_resolution);
+
+// seconds, 0 is 0.5
+constexpr uint8_t time_lapse_values[] SETTINGS_PROGMEM = {0, 1, 5, 10, 30, 60};
+constexpr uint8_t time_lapse_hero3[] SETTINGS_PROGMEM = {0x00, 0x01, 0x05, 0x0a, 0x1e, 0x3c};
+constexpr uint8_t time_lapse_hero4[] SETTINGS_PROGMEM = {0, 1, 3, 4, 5, 6};
+constexpr char time_lapse_command[] SETTINGS_PROGMEM = "TI";
+
+// pictures per second
+constexpr uint8_t continuous_shot_values[] SETTINGS_PROGMEM = {0, 3, 5, 10};
+constexpr uint8_t continuous_shot_hero3[] SETTINGS_PROGMEM = {0x00, 0x03, 0x05, 0x0a};
+constexpr char continuous_shot_command[] SETTINGS_PROGMEM = "CS";
+
+#undef X
+#undef CHECK_CODES
+
+constexpr SettingTable settings_table[] SETTINGS_PROGMEM = {
+    {mode_first, sizeof(mode_hero4), nullptr, mode_command,
+     {0, 0, 0}, {mode_hero3, mode_hero4, mode_hero4}},
+    {orientation_first, sizeof(orientation_hero4), nullptr, orientation_command,
+     {0, 52, 52}, {orientation_hero3, orientation_hero4, orientation_hero4}},
+    {video_resolution_first, sizeof(video_resolution_hero4), nullptr, video_resolution_command,
+     {0, 2, 2}, {video_resolution_hero3, video_resolution_hero4, video_resolution_hero4}},
+    {video_fov_first, sizeof(video_fov_hero4), nullptr, video_fov_command,
+     {0, 4, 121}, {video_fov_hero3, video_fov_hero4, video_fov_hero8}},
+    {frame_rate_first, sizeof(frame_rate_hero4), nullptr, frame_rate_command,
+     {0, 3, 3}, {frame_rate_hero3, frame_rate_hero4, frame_rate_hero4}},
+    {video_encoding_first, sizeof(video_encoding_codes), nullptr, video_encoding_command,
+     {0, 57, 57}, {video_encoding_codes, video_encoding_codes, video_encoding_codes}},
+    {photo_resolution_first, sizeof(photo_resolution_hero4), nullptr, photo_resolution_command,
+     {0, 17, 17}, {photo_resolution_hero3, photo_resolution_hero4, photo_resolution_hero4}},
+    {0, sizeof(time_lapse_values), time_lapse_values, time_lapse_command,
+     {0, 5, 5}, {time_lapse_hero3, time_lapse_hero4, time_lapse_hero4}},
+    {0, sizeof(continuous_shot_values), continuous_shot_values, continuous_shot_command,
+     {0, 0, 0}, {continuous_shot_hero3, nullptr, nullptr}},
+};
+static_assert(sizeof(settings_table) / sizeof(settings_table[0]) == setting_kinds,
+              "a setting is missing");
+
+// Order used by applyProfile(): the mode decides which settings exist, the
+// encoding and the resolution decide which frame rates are allowed
+constexpr uint8_t profile_order[] SETTINGS_PROGMEM = {
+    SETTING_MODE, SETTING_VIDEO_ENCODING, SETTING_VIDEO_RESOLUTION, SETTING_FRAME_RATE,
+    SETTING_VIDEO_FOV, SETTING_ORIENTATION, SETTING_PHOTO_RESOLUTION, SETTING_TIME_LAPSE,
+    SETTING_CONTINUOUS_SHOT};
+static_assert(sizeof(profile_order) == setting_kinds, "a setting is missing");
+
+// a byte of the tables above
+static inline uint8_t settingByte(const uint8_t *address)
+{
+#if defined(__AVR__)
+  return pgm_read_byte(address);
+#else
+  return *address;
+#endif
+}
+
+// a row of settings_table, its arrays and its command stay in flash on AVR
+static inline SettingTable readSettingTable(const uint8_t kind)
+{
+  SettingTable table;
+#if defined(__AVR__)
+  memcpy_P(&table, &settings_table[kind], sizeof(table));
+#else
+  table = settings_table[kind];
+#endif
+  return table;
+}
+
+#endif // GOPRO_SETTINGS_TABLE_H
@@ -0,0 +1,268 @@
+/*
+StatusParser.cpp
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include <StatusParser.h>
+
+// ids of the "status" object, see
+// https://github.com/KonradIT/goprowifihack/blob/master/HERO5/CameraStatus.md
+#define STATUS_BATTERY_LEVEL 2
+#define STATUS_BUSY 8
+#define STATUS_ENCODING 10
+#define STATUS_SD 33
+#define STATUS_REMAINING_PHOTOS 34
+#define STATUS_REMAINING_VIDEO 35
+#define STATUS_PHOTOS 38
+#define STATUS_VIDEOS 39
+#define STATUS_MODE 43
+#define STATUS_SUB_MODE 44
+#define STATUS_BATTERY 70
+
+#define BATTERY_CHARGING 4
+
+static void clearStatus(GoProStatus *status)
+{
+  memset(status, 0, sizeof(GoProStatus));
+  status->powered = true; // a sleeping camera doesn't answer
+  status->battery = NO_CODE;
+  status->battery_level = NO_CODE;
+  status->mode = NO_CODE;
+  status->sub_mode = NO_CODE;
+  memset(status->settings, NO_CODE, sizeof(status->settings));
+}
+
+uint16_t statusChanges(const GoProStatus &before, const GoProStatus &after)
+{
+  uint16_t changed = 0;
+  if (before.powered != after.powered)
+  {
+    changed |= CHANGED_POWER;
+  }
+  if (before.battery != after.battery || before.battery_level != after.battery_level ||
+      before.charging != after.charging)
+  {
+    changed |= CHANGED_BATTERY;
+  }
+  if (before.recording != after.recording)
+  {
+    changed |= CHANGED_RECORDING;
+  }
+  if (before.busy != after.busy)
+  {
+    changed |= CHANGED_BUSY;
+  }
+  if (before.sd_status != after.sd_status)
+  {
+    changed |= CHANGED_SD_CARD;
+  }
+  if (before.mode != after.mode || before.sub_mode != after.sub_mode)
+  {
+    changed |= CHANGED_MODE;
+  }
+  if (before.remaining_photos != after.remaining_photos ||
+      before.remaining_video != after.remaining_video)
+  {
+    changed |= CHANGED_REMAINING;
+  }
+  if (before.photos != after.photos || before.videos != after.videos)
+  {
+    changed |= CHANGED_MEDIA;
+  }
+  if (memcmp(before.settings, after.settings, sizeof(before.settings)) != 0)
+  {
+    changed |= CHANGED_SETTINGS;
+  }
+  return changed;
+}
+
+////////////////////////////////////////////////////////////
+////////                HERO4 and newer            /////////
+////////////////////////////////////////////////////////////
+
+void StatusParser::reset(GoProStatus *status, const uint8_t ids[setting_kinds])
+{
+  resetStream();
+  _status = status;
+  _ids = ids;
+  _section = SECTION_NONE;
+  _mode = NO_CODE;
+  _sub_mode = NO_CODE;
+  clearStatus(_status);
+}
+
+void StatusParser::onOpen(const uint8_t depth, const bool array, const char *key)
+{
+  if (depth == 2 && !array)
+  {
+    if (strcmp(key, "status") == 0)
+    {
+      _section = SECTION_STATUS;
+    }
+    else if (strcmp(key, "settings") == 0)
+    {
+      _section = SECTION_SETTINGS;
+    }
+  }
+}
+
+void StatusParser::onClose(const uint8_t depth, const bool array)
+{
+  (void)array;
+  if (depth == 2)
+  {
+    _section = SECTION_NONE;
+  }
+}
+
+void StatusParser::onValue(const uint8_t depth, const char *key, const char *value)
+{
+  if (depth != 2 || _section == SECTION_NONE)
+  {
+    return;
+  }
+
+  const uint8_t id = atoi(key);
+  if (_section == SECTION_SETTINGS)
+  {
+    for (uint8_t kind = 0; kind < setting_kinds; kind++)
+    {
+      if (_ids[kind] != 0 && _ids[kind] == id)
+      {
+        _status->settings[kind] = atoi(value);
+      }
+    }
+    return;
+  }
+
+  switch (id)
+  {
+  case STATUS_BATTERY_LEVEL:
+    _status->battery_level = atoi(value);
+    _status->charging = _status->battery_level == BATTERY_CHARGING;
+    break;
+  case STATUS_BUSY:
+    _status->busy = atoi(value) != 0;
+    break;
+  case STATUS_ENCODING:
+    _status->recording = atoi(value) != 0;
+    break;
+  case STATUS_SD:
+    _status->sd_status = atoi(value);
+    break;
+  case STATUS_REMAINING_PHOTOS:
+    _status->remaining_photos = strtoul(value, nullptr, 10);
+    break;
+  case STATUS_REMAINING_VIDEO:
+    _status->remaining_video = strtoul(value, nullptr, 10);
+    break;
+  case STATUS_PHOTOS:
+    _status->photos = atoi(value);
+    break;
+  case STATUS_VIDEOS:
+    _status->videos = atoi(value);
+    break;
+  case STATUS_MODE:
+    _mode = atoi(value);
+    break;
+  case STATUS_SUB_MODE:
+    _sub_mode = atoi(value);
+    break;
+  case STATUS_BATTERY:
+    _status->battery = atoi(value);
+    break;
+  default:
+    break;
+  }
+}
+
+////////////////////////////////////////////////////////////
+////////                    HERO3                  /////////
+////////////////////////////////////////////////////////////
+
+void Hero3StatusParser::reset(GoProStatus *status)
+{
+  _status = status;
+  _offset = 0;
+  _high = 0;
+  _mode = NO_CODE;
+  clearStatus(_status);
+}
+
+void Hero3StatusParser::feed(void *context, const char *data, uint16_t len)
+{
+  Hero3StatusParser *parser = (Hero3StatusParser *)context;
+  for (uint16_t i = 0; i < len && parser->_offset < HERO3_STATUS_LEN; i++)
+  {
+    parser->decode(data[i]);
+    parser->_offset++;
+  }
+}
+
+void Hero3StatusParser::decode(const uint8_t value)
+{
+  const uint16_t counter = (_high << 8) | value;
+
+  switch (_offset)
+  {
+  case HERO3_STATUS_POWER:
+    _status->powered = value == 0;
+    break;
+  case HERO3_STATUS_MODE:
+    _mode = value;
+    break;
+  case HERO3_STATUS_TIME_LAPSE:
+    _status->settings[SETTING_TIME_LAPSE] = value;
+    break;
+  case HERO3_STATUS_VIDEO_FOV:
+    _status->settings[SETTING_VIDEO_FOV] = value;
+    break;
+  case HERO3_STATUS_PHOTO_RESOLUTION:
+    _status->settings[SETTING_PHOTO_RESOLUTION] = value;
+    break;
+  case HERO3_STATUS_BATTERY:
+    _status->battery = value;
+    break;
+  case HERO3_STATUS_REMAINING_PHOTOS + 1:
+    _status->remaining_photos = counter;
+    break;
+  case HERO3_STATUS_PHOTOS + 1:
+    _status->photos = counter;
+    break;
+  case HERO3_STATUS_REMAINING_VIDEO + 1:
+    _status->remaining_video = counter * 60UL;
+    break;
+  case HERO3_STATUS_VIDEOS + 1:
+    _status->videos = counter;
+    break;
+  case HERO3_STATUS_RECORDING:
+    _status->recording = value != 0;
+    break;
+  case HERO3_STATUS_VIDEO_RESOLUTION:
+    _status->settings[SETTING_VIDEO_RESOLUTION] = value;
+    break;
+  case HERO3_STATUS_FRAME_RATE:
+    _status->settings[SETTING_FRAME_RATE] = value;
+    break;
+  default:
+    break;
+  }
+  _high = value;
+}
@@ -0,0 +1,139 @@
+/*
+StatusParser.h
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#ifndef GOPRO_STATUS_PARSER_H
+#define GOPRO_STATUS_PARSER_H
+
+#include <JSONStream.h>
+#include <Settings.h>
+
+// Snapshot of the camera, the same for every model
+struct GoProStatus
+{
+  bool powered;
+  uint8_t battery;          // percentage, NO_CODE if the camera doesn't give it
+  uint8_t battery_level;    // 0 empty .. 3 full, NO_CODE if unknown
+  bool charging;
+  bool recording;
+  bool busy;
+  int8_t sd_status;         // 0 ok, -1 no card, other values are errors
+  uint8_t mode;             // VIDEO_MODE, PHOTO_MODE, ... NO_CODE if unknown
+  uint8_t sub_mode;         // VIDEO_LOOPING_MODE, ... NO_CODE if there is none
+  uint32_t remaining_photos;
+  uint32_t remaining_video; // seconds
+  uint16_t photos;          // on the SD card
+  uint16_t videos;
+  // current option of every setting_kind (VR_1080p, FR_60, 5 seconds of
+  // time-lapse, ...), SETTING_MODE is sub_mode or mode if there is no sub mode
+  uint8_t settings[setting_kinds];
+};
+
+// Fields of GoProStatus, as bits of the mask returned by statusChanges()
+enum status_field : uint16_t
+{
+  CHANGED_POWER = 1 << 0,
+  CHANGED_BATTERY = 1 << 1, // battery, battery_level or charging
+  CHANGED_RECORDING = 1 << 2,
+  CHANGED_BUSY = 1 << 3,
+  CHANGED_SD_CARD = 1 << 4,
+  CHANGED_MODE = 1 << 5, // mode or sub_mode
+  CHANGED_REMAINING = 1 << 6, // remaining_photos or remaining_video
+  CHANGED_MEDIA = 1 << 7, // photos or videos
+  CHANGED_SETTINGS = 1 << 8,
+  CHANGED_ALL = (1 << 9) - 1
+};
+
+// Which fields are different between two snapshots
+uint16_t statusChanges(const GoProStatus &before, const GoProStatus &after);
+
+// Streaming decoder of /gp/gpControl/status: it fills a GoProStatus while the
+// JSON arrives, the settings are left as the codes of the camera
+class StatusParser : public JSONStream
+{
+public:
+  // ids is the id of every setting_kind in the "settings" object, 0 if the
+  // camera doesn't have it
+  void reset(GoProStatus *status, const uint8_t ids[setting_kinds]);
+
+  uint8_t modeCode() const { return _mode; }
+  uint8_t subModeCode() const { return _sub_mode; }
+
+protected:
+  void onOpen(const uint8_t depth, const bool array, const char *key) override;
+  void onClose(const uint8_t depth, const bool array) override;
+  void onValue(const uint8_t depth, const char *key, const char *value) override;
+
+private:
+  enum Section : uint8_t
+  {
+    SECTION_NONE,
+    SECTION_STATUS,
+    SECTION_SETTINGS
+  };
+
+  GoProStatus *_status = nullptr;
+  const uint8_t *_ids = nullptr;
+  Section _section = SECTION_NONE;
+  uint8_t _mode = NO_CODE;
+  uint8_t _sub_mode = NO_CODE;
+};
+
+// Bytes of the HERO3 /camera/sx block, the 16 bits counters are big endian, see
+// https://github.com/KonradIT/goprowifihack/blob/master/HERO3/WifiCommands.md
+#define HERO3_STATUS_POWER 0 // 0 when the camera is on
+#define HERO3_STATUS_MODE 1
+#define HERO3_STATUS_TIME_LAPSE 4
+#define HERO3_STATUS_VIDEO_FOV 7
+#define HERO3_STATUS_PHOTO_RESOLUTION 8
+#define HERO3_STATUS_BATTERY 19
+#define HERO3_STATUS_REMAINING_PHOTOS 21
+#define HERO3_STATUS_PHOTOS 23
+#define HERO3_STATUS_REMAINING_VIDEO 25 // minutes
+#define HERO3_STATUS_VIDEOS 27
+#define HERO3_STATUS_RECORDING 29
+#define HERO3_STATUS_VIDEO_RESOLUTION 50
+#define HERO3_STATUS_FRAME_RATE 51
+#define HERO3_STATUS_LEN 52 // the block can be longer, the rest is not decoded
+
+// Streaming decoder of the binary HERO3 /camera/sx block: every byte is
+// decoded when it arrives, nothing is buffered
+class Hero3StatusParser
+{
+public:
+  void reset(GoProStatus *status);
+
+  // Body sink, context is the Hero3StatusParser
+  static void feed(void *context, const char *data, uint16_t len);
+
+  bool isComplete() const { return _offset >= HERO3_STATUS_LEN; }
+  uint8_t modeCode() const { return _mode; }
+
+private:
+  GoProStatus *_status = nullptr;
+  uint16_t _offset = 0;
+  uint8_t _high = 0; // first byte of a 16 bits counter
+  uint8_t _mode = NO_CODE;
+
+  void decode(const uint8_t value);
+};
+
+#endif // GOPRO_STATUS_PARSER_H